@@ -9,10 +9,34 @@
  *         The library currently includes the following components:
  *         - defer: Provides a macro for deferring the execution of a function call to the end of the current scope.
  *         - cstring_obfuscator: Provides a set of tools for obfuscating at compile-time and deobfuscating at runtime C-style strings.
+ *         - xor_string_pool: Provides a pool of obfuscated C-style strings stored in one contiguous encrypted blob.
+ *         - xor_string_map: Provides a compile-time perfect-hash lookup table keyed by obfuscated C-style strings.
+ *         - xor_blob: Provides compile-time obfuscation of binary payloads with chunked streaming decryption.
+ *         - xor_parallel: Provides multi-threaded decryption of large obfuscated payloads; its standard execution policy overloads need TBX_XSTR_EXECUTION (and -ltbb with libstdc++).
+ *         - xor_aes: Provides an AES-128 counter-mode keystream policy for obfuscated C-style strings.
+ *         - xor_log: Provides logging macros whose obfuscated format strings are only decrypted when the message is written.
+ *         - xor_sink: Provides ostream, output-iterator and file descriptor sinks that decrypt obfuscated data straight into their destination.
+ *
+ *         The following POSIX-only components are not included here and must be included on their own:
+ *         - xor_pack: Provides an mmap-based reader for obfuscated resource packs written by tools/xorpack.cpp.
+ *         - xor_lazy_mapping: Provides lazy page-by-page decryption of resource pack entries through Linux userfaultfd.
+ *         - xor_async_writer: Provides a Linux io_uring writer that decrypts payloads to files while earlier chunks are being written.
+ *
+ *         The following C++20 component is not included here either, as it needs <format> or {fmt}:
+ *         - xor_format: Provides std::format and {fmt} formatting with obfuscated, compile-time checked format strings.
  * 
  * \author Kam1k4dze
  * \date   April 2024
  */
 #pragma once
-#include <kam1k4dze/utools/defer.hpp>
 #include <kam1k4dze/utools/cstring_obfuscator.hpp>
+#include <kam1k4dze/utools/xor_string_pool.hpp>
+#include <kam1k4dze/utools/xor_string_map.hpp>
+#include <kam1k4dze/utools/xor_blob.hpp>
+#include <kam1k4dze/utools/xor_parallel.hpp>
+#include <kam1k4dze/utools/xor_aes.hpp>
+#include <kam1k4dze/utools/xor_log.hpp>
+#include <kam1k4dze/utools/xor_sink.hpp>
+// Last: the `defer` macro would otherwise rewrite standard headers such as
+// <execution> (included with TBX_XSTR_EXECUTION) that use that identifier.
+#include <kam1k4dze/utools/defer.hpp>
@@ -7,15 +7,32 @@
  *         The file defines a set of macros and a crypt namespace containing
  *         the Xor_string class template for encrypting and decrypting strings.
  *         The encryption uses a simple XOR cipher with a compile-time generated
- *         key.
+ *         key. The keystream is a policy parameter of Xor_string: the default
+ *         Ramp_keystream, or Counter_keystream which hashes a counter.
  *
  *         The macros XorString, _c, XorWS, XorWideString, and _cw provide
  *         convenient ways to create encrypted strings and decrypt them at runtime.
+ *         XorStringCached, _cc, XorWideStringCached and _ccw decrypt each
+ *         literal site only once. With C++20, the "..."_xs literal of
+ *         crypt::literals shares one encrypted copy of each distinct string
+ *         across translation units.
  *@note define TBX_XSTR_SEED before including this file to change the seed value
+ *@note define TBX_XSTR_CACHE before including this file to make _c and _cw
+ *      use the decrypt-once cached mode
  * @date   April 2024
  */
 #pragma once
 
+#include <kam1k4dze/utools/xor_kernel.hpp>
+
+#include <array>
+#include <atomic>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#if __has_include(<span>)
+#include <span>
+#endif
 
 namespace crypt {
 // =============================================================================
@@ -35,10 +52,10 @@ namespace crypt {
 
 // @return a pseudo random number clamped at 0xFFFFFFFF
 constexpr unsigned long long linear_congruent_generator(unsigned rounds) {
-  return 1013904223ull +
-         (1664525ull * ((rounds > 0) ? linear_congruent_generator(rounds - 1)
-                                     : (TBX_XSTR_SEED))) %
-             0xFFFFFFFF;
+  unsigned long long x = TBX_XSTR_SEED;
+  for (unsigned i = 0; i <= rounds; ++i)
+    x = 1013904223ull + (1664525ull * x) % 0xFFFFFFFF;
+  return x;
 }
 
 // -----------------------------------------------------------------------------
@@ -59,29 +76,438 @@ constexpr Char encrypt_character(const Char character, int index) {
 
 // -----------------------------------------------------------------------------
 
-template <unsigned size, typename Char> class Xor_string {
+namespace detail {
+// GCC caps the iterations of each constexpr loop with -fconstexpr-loop-limit
+// (262144 by default), so compile-time encryption walks long literals in
+// chunks of this many characters, one inner loop per chunk.
+constexpr std::size_t constexpr_chunk = 4096;
+
+constexpr std::size_t constexpr_chunk_end(std::size_t pos, std::size_t n) {
+  return n - pos < constexpr_chunk ? n : pos + constexpr_chunk;
+}
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+
+// Seed of the counter-mode keystream, drawn from the same generator as XORKEY.
+constexpr const std::uint32_t XORSEED =
+    static_cast<std::uint32_t>(linear_congruent_generator(20));
+
+// -----------------------------------------------------------------------------
+
+// A keystream policy tells Xor_string how to encrypt and decrypt:
+// - at<Char>(i): constexpr keystream of the character at index i, used by
+//   char_at();
+// - encrypt(dst, src, n): constexpr, XORs the first n characters of src with
+//   the keystream into dst, used by the compile-time constructor;
+// - apply(dst, src, n, pos): XORs n characters starting at index pos with the
+//   keystream at runtime, dst and src may alias;
+// - equal(encrypted, probe, n, pos): compares a probe with an encrypted range
+//   without decrypting it, in time independent of the first mismatch.
+
+/**
+ * @brief The original keystream: character i is XORed with (XORKEY + i).
+ *
+ * The cheapest policy and the default; also used by Xor_string_pool,
+ * Xor_string_map and Xor_blob.
+ */
+struct Ramp_keystream {
+  template <typename Char> static constexpr Char at(std::size_t i) {
+    return static_cast<Char>(static_cast<Char>(XORKEY) + i);
+  }
+
+  template <typename Char>
+  static constexpr void encrypt(Char *dst, const Char *src, std::size_t n) {
+    for (std::size_t pos = 0; pos < n; pos += detail::constexpr_chunk)
+      for (std::size_t i = pos, end = detail::constexpr_chunk_end(pos, n);
+           i < end; ++i)
+        dst[i] = static_cast<Char>(src[i] ^ static_cast<Char>(XORKEY + i));
+  }
+
+  template <typename Char>
+  static void apply(Char *dst, const Char *src, std::size_t n,
+                    std::size_t pos) {
+    detail::xor_keystream<Char>(dst, src, n, static_cast<Char>(XORKEY), pos);
+  }
+
+  template <typename Char>
+  static bool equal(const Char *encrypted, const Char *probe, std::size_t n,
+                    std::size_t pos) {
+    return detail::xor_keystream_equal<Char>(encrypted, probe, n,
+                                             static_cast<Char>(XORKEY), pos);
+  }
+};
+
+/**
+ * @brief Counter-mode keystream: every 4 bytes of the string are XORed with a
+ *        murmur3-finalized hash of (XORSEED ^ word index).
+ *
+ * Neighbouring characters no longer share a key up to a known offset, so
+ * recovering one plaintext character says nothing about the others, while
+ * the generator stays stateless per word and runs at close to the speed of
+ * the ramp with the SSE4.1/AVX2/AVX-512 kernels.
+ */
+struct Counter_keystream {
+  template <typename Char> static constexpr Char at(std::size_t i) {
+    return detail::counter_keystream_char<Char>(XORSEED, i);
+  }
+
+  template <typename Char>
+  static constexpr void encrypt(Char *dst, const Char *src, std::size_t n) {
+    for (std::size_t pos = 0; pos < n; pos += detail::constexpr_chunk)
+      detail::counter_keystream_encrypt(
+          dst + pos, src + pos, detail::constexpr_chunk_end(pos, n) - pos,
+          XORSEED, pos);
+  }
+
+  template <typename Char>
+  static void apply(Char *dst, const Char *src, std::size_t n,
+                    std::size_t pos) {
+    detail::counter_keystream<Char>(dst, src, n, XORSEED, pos);
+  }
+
+  template <typename Char>
+  static bool equal(const Char *encrypted, const Char *probe, std::size_t n,
+                    std::size_t pos) {
+    return detail::counter_keystream_equal<Char>(encrypted, probe, n, XORSEED,
+                                                 pos);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Compile-time encrypted, null-terminated string of @c size characters.
+ *
+ * The object holds only the encrypted payload: its length is a static
+ * constant, so sizeof(Xor_string<size, Char>) == size * sizeof(Char), the type
+ * is trivially copyable and assignable, and tables of encrypted literals pack
+ * densely and can be copied with memcpy.
+ *
+ * With GCC's default constexpr limits, literals of up to 256 KiB encrypt at
+ * compile time, 64 KiB with Aes_ctr_keystream; see tools/xstr_compile_bench.py.
+ *
+ * @tparam Keystream Keystream policy: Ramp_keystream, Counter_keystream or
+ *                   Aes_ctr_keystream (xor_aes.hpp).
+ *
+ * @code
+ * constexpr crypt::Xor_string<sizeof("token"), char, crypt::Counter_keystream>
+ *     token("token");
+ * @endcode
+ */
+template <unsigned size, typename Char, class Keystream = Ramp_keystream>
+class Xor_string {
 public:
-  const unsigned _nb_chars = (size - 1);
+  static constexpr unsigned _nb_chars = (size - 1);
   Char _string[size];
 
+  constexpr Xor_string() : _string{} {}
+
   // if every goes alright this constructor should be executed at compile time
   inline constexpr Xor_string(const Char *string) : _string{} {
-    for (unsigned i = 0u; i < size; ++i)
-      _string[i] = encrypt_character<Char>(string[i], i);
+    Keystream::encrypt(_string, string, size);
   }
 
   // This is executed at runtime.
   // HACK: although decrypt() is const we modify '_string' in place
   const Char *decrypt() const {
     Char *string = const_cast<Char *>(_string);
-    for (unsigned t = 0; t < _nb_chars; t++) {
-      string[t] = string[t] ^ (static_cast<Char>(XORKEY) + t);
+    detail::xor_decrypt<Keystream>(string, string, _nb_chars);
+    return string;
+  }
+
+  /**
+   * @brief Decrypts the string in place like decrypt() and returns it as a
+   *        string view, so the length known at compile time does not need to
+   *        be recovered with strlen.
+   *
+   * HACK: like decrypt(), this modifies '_string' in place although it is
+   * const. Call it once, on an object in writable storage such as the
+   * temporary of XorStringView; constexpr objects may live in .rodata, use
+   * decrypt_view(Char (&)[size]) for those.
+   */
+  std::basic_string_view<Char> decrypt_view() const {
+    return {decrypt(), size - 1};
+  }
+
+  /**
+   * @brief Decrypts the string into a caller-provided buffer and returns it as
+   *        a string view over that buffer.
+   *
+   * @see decrypt_to(Char (&)[size])
+   */
+  std::basic_string_view<Char> decrypt_view(Char (&out)[size]) const {
+    return {decrypt_to(out), size - 1};
+  }
+
+  /**
+   * @brief Decrypts the string into a caller-provided buffer.
+   *
+   * Unlike decrypt(), this never writes to the object itself, so it is safe
+   * to call any number of times and from several threads at once, and works
+   * on objects placed in read-only memory.
+   *
+   * @param out Destination; receives the characters and the null terminator.
+   * @return out
+   */
+  const Char *decrypt_to(Char (&out)[size]) const {
+    detail::xor_decrypt<Keystream>(out, _string, size - 1);
+    return out;
+  }
+
+#ifdef __cpp_lib_span
+  /**
+   * @brief Decrypts the string into a caller-provided buffer.
+   *
+   * @param out Destination of at least @c size characters; receives the
+   *            characters and the null terminator.
+   * @return out.data(), or nullptr without writing anything if @p out is
+   *         shorter than @c size characters
+   *
+   * @see decrypt_to(Char (&)[size])
+   */
+  const Char *decrypt_to(std::span<Char> out) const {
+    if (out.size() < size)
+      return nullptr;
+    detail::xor_decrypt<Keystream>(out.data(), _string, size - 1);
+    return out.data();
+  }
+#endif
+
+  /**
+   * @brief Decrypts a slice of the string without touching the rest of it.
+   *
+   * Because the key only depends on the position of a character, any slice
+   * can be decrypted on its own. Like std::basic_string::substr(), @p len is
+   * clamped to the end of the string. The output is not null-terminated.
+   *
+   * @param pos First character of the slice, at most _nb_chars.
+   * @param len Number of characters to decrypt.
+   * @param out Destination of at least min(len, _nb_chars - pos) characters.
+   * @return a view over the decrypted slice inside @p out, empty without
+   *         writing anything if @p pos is past the end
+   */
+  std::basic_string_view<Char> decrypt_range(unsigned pos, unsigned len,
+                                             Char *out) const {
+    if (pos > _nb_chars)
+      return {out, 0};
+    if (len > _nb_chars - pos)
+      len = _nb_chars - pos;
+    Keystream::apply(out, _string + pos, len, pos);
+    return {out, len};
+  }
+
+  // @return the decrypted character at index @p i, at most _nb_chars; the
+  //         null character past the end
+  constexpr Char char_at(unsigned i) const {
+    if (i > _nb_chars)
+      return Char{};
+    return static_cast<Char>(_string[i] ^ Keystream::template at<Char>(i));
+  }
+
+  /**
+   * @brief Checks whether the plaintext equals @p probe, without decrypting.
+   *
+   * The probe is encrypted on the fly with the same keystream and compared
+   * in the encrypted domain with the vector kernels. The running time only
+   * depends on the lengths, not on the position of the first mismatch.
+   */
+  bool equals(std::basic_string_view<Char> probe) const {
+    if (probe.size() != _nb_chars)
+      return false;
+    return Keystream::equal(_string, probe.data(), _nb_chars, 0);
+  }
+
+  // @return true if the plaintext starts with @p prefix, see equals()
+  bool starts_with(std::basic_string_view<Char> prefix) const {
+    if (prefix.size() > _nb_chars)
+      return false;
+    return Keystream::equal(_string, prefix.data(), prefix.size(), 0);
+  }
+
+  /**
+   * @brief Three-way lexicographic comparison of the plaintext with
+   *        @p probe, ordering characters by their unsigned code units like
+   *        memcmp.
+   *
+   * The plaintext is only ever decrypted one character at a time in a
+   * register. Every character of the common prefix is examined without
+   * early exit.
+   *
+   * @return a negative value, zero or a positive value if the plaintext is
+   *         respectively less than, equal to or greater than @p probe
+   */
+  int compare(std::basic_string_view<Char> probe) const {
+    using Unsigned = std::make_unsigned_t<Char>;
+    const std::size_t n =
+        probe.size() < _nb_chars ? probe.size() : std::size_t{_nb_chars};
+    int result = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const Unsigned a = static_cast<Unsigned>(char_at(i));
+      const Unsigned b = static_cast<Unsigned>(probe[i]);
+      const int order = (a > b) - (a < b);
+      result |= order & -static_cast<int>(result == 0);
+    }
+    const int by_length =
+        (_nb_chars > probe.size()) - (_nb_chars < probe.size());
+    return result | (by_length & -static_cast<int>(result == 0));
+  }
+
+  /**
+   * @brief Decrypts the string into a null-terminated array returned by value.
+   *
+   * The object is left untouched. Short strings stay on the stack or in
+   * registers of the caller.
+   */
+  std::array<Char, size> decrypt_array() const {
+    std::array<Char, size> out;
+    detail::xor_decrypt<Keystream>(out.data(), _string, size - 1);
+    return out;
+  }
+};
+
+static_assert(sizeof(Xor_string<16, char>) == 16 * sizeof(char),
+              "Xor_string must hold only the encrypted payload");
+static_assert(std::is_trivially_copyable<Xor_string<16, wchar_t>>::value,
+              "Xor_string must be memcpy-able");
+
+/**
+ * @brief Concatenates encrypted strings into a single encrypted string.
+ *
+ * Meant for constant expressions: the parts are decrypted and the result is
+ * encrypted again at compile time, keyed for its own positions, so the
+ * composed string is one object that decrypts in a single pass into a buffer
+ * whose size is known at compile time.
+ *
+ * @code
+ * XorS(scheme, "https://");
+ * XorS(host, "example.com");
+ * XorS(path, "/index.html");
+ * constexpr auto url = crypt::concat(scheme, host, path); // or scheme + host
+ * char buffer[url._nb_chars + 1];
+ * puts(url.decrypt_to(buffer));
+ * @endcode
+ *
+ * @note Decrypting the parts counts against the same constexpr limits as
+ *       encrypting the result, see Xor_string.
+ * @note Evaluated at runtime, this would hold the plaintext on the stack.
+ */
+template <typename Char, class Keystream, unsigned... sizes>
+constexpr Xor_string<(sizes + ... + 1) - sizeof...(sizes), Char, Keystream>
+concat(const Xor_string<sizes, Char, Keystream> &...parts) {
+  static_assert(sizeof...(sizes) > 0, "nothing to concatenate");
+  constexpr unsigned size = (sizes + ... + 1) - sizeof...(sizes);
+  Char plain[size]{};
+  std::size_t pos = 0;
+  // The keystream is applied with XOR: encrypting the ciphertext again at
+  // the same positions yields the plaintext.
+  ((Keystream::encrypt(plain + pos, parts._string, sizes - 1),
+    pos += sizes - 1),
+   ...);
+  return Xor_string<size, Char, Keystream>(plain);
+}
+
+// @see concat()
+template <typename Char, class Keystream, unsigned lsize, unsigned rsize>
+constexpr Xor_string<lsize + rsize - 1, Char, Keystream>
+operator+(const Xor_string<lsize, Char, Keystream> &lhs,
+          const Xor_string<rsize, Char, Keystream> &rhs) {
+  return concat(lhs, rhs);
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Per-site storage for a string that is decrypted only once.
+ *
+ * The first call to get() decrypts the string into the cache and publishes it
+ * with a release store; every later call is a single acquire load. Threads
+ * that lose the race for the first decryption wait until the winner has
+ * published the plaintext. Instances are meant to be function-local statics:
+ * the constructor is constexpr, so no guard variable is emitted for them.
+ *
+ * @note The plaintext stays in memory for the lifetime of the program.
+ */
+template <unsigned size, typename Char, class Keystream = Ramp_keystream>
+class Xor_string_cache {
+public:
+  using encrypted_type = Xor_string<size, Char, Keystream>;
+
+  constexpr Xor_string_cache() = default;
+
+  const Char *get(const encrypted_type &encrypted) {
+    if (const Char *string = _ready.load(std::memory_order_acquire))
+      return string;
+    return decrypt_once(encrypted);
+  }
+
+  // Same as get(), with the length known at compile time.
+  std::basic_string_view<Char>
+  get_view(const encrypted_type &encrypted) {
+    return {get(encrypted), size - 1};
+  }
+
+private:
+  const Char *decrypt_once(const encrypted_type &encrypted) {
+    if (!_claimed.exchange(true, std::memory_order_acquire)) {
+      encrypted.decrypt_to(_plain);
+      _ready.store(_plain, std::memory_order_release);
+      return _plain;
     }
-    string[_nb_chars] = '\0';
+    const Char *string;
+    while (!(string = _ready.load(std::memory_order_acquire)))
+      std::this_thread::yield();
     return string;
   }
+
+  std::atomic<const Char *> _ready{nullptr};
+  std::atomic<bool> _claimed{false};
+  Char _plain[size]{};
 };
 
+#if defined(__cpp_nontype_template_args) &&                                    \
+    __cpp_nontype_template_args >= 201911L
+// -----------------------------------------------------------------------------
+
+// Lets a string literal initialize an Xor_string template parameter.
+template <unsigned size, typename Char>
+Xor_string(const Char (&)[size]) -> Xor_string<size, Char>;
+
+namespace detail {
+/**
+ * The single copy of the encrypted literal @p S. Each distinct literal is one
+ * instantiation of this variable and of operator""_xs, folded by the linker
+ * across translation units, so a string used in many files is stored once.
+ *
+ * The template argument is encrypted when it is formed: symbol names built
+ * from it only ever contain the ciphertext.
+ */
+template <Xor_string S> inline constexpr auto xor_literal = S;
+} // namespace detail
+
+inline namespace literals {
+/**
+ * @brief Compile-time encrypted string literal (C++20).
+ *
+ * Unlike the macros, this creates no lambda and no constexpr object at the
+ * call site: the literal is a template argument and its encrypted storage is
+ * shared by every use of the same string in the program. The result is a
+ * copy of that storage, to be decrypted like the object of XorS.
+ *
+ * @code
+ * using namespace crypt::literals;
+ * std::puts("Hello, World!"_xs.decrypt());
+ * auto name = L"user"_xs.decrypt_array(); // wide literals work the same way
+ * @endcode
+ *
+ * @note Uses the default keystream policy.
+ */
+template <Xor_string S> constexpr auto operator""_xs() {
+  return detail::xor_literal<S>;
+}
+} // namespace literals
+#endif
+
 } // namespace crypt
 
 
@@ -134,6 +560,9 @@ public:
  *
  * @note The C-string must be a string literal.
  * @note The C-string must be null-terminated.
+ * @note The returned pointer refers to a temporary and is only valid until the
+ *       end of the full-expression. Use crypt::Xor_string::decrypt_array() or
+ *       decrypt_to() to keep the plaintext around.
  */
 #define XorString(my_string)                                                   \
   [] {                                                                         \
@@ -161,7 +590,11 @@ public:
  * @note The C-string must be a string literal.
  * @note The C-string must be null-terminated.
  */
+#ifdef TBX_XSTR_CACHE
+#define _c(string) XorStringCached(string)
+#else
 #define _c(string) XorString(string)
+#endif
 
 
 /**
@@ -237,6 +670,168 @@ public:
  * @note The C-string must be a wide string literal.
  * @note The C-string must be null-terminated.
  */
+#ifdef TBX_XSTR_CACHE
+#define _cw(string) XorWideStringCached(string)
+#else
 #define _cw(string) XorWideString(string)
+#endif
+
+
+/**
+ * @brief Creates an anonymous compile-time encrypted C-string that is
+ * decrypted only once.
+ *
+ * Unlike XorString, the C-string is decrypted the first time the expression
+ * is evaluated into static storage private to this call site. Later
+ * evaluations return the cached pointer after a single acquire load, which
+ * makes this suitable for literals inside hot loops. The returned pointer
+ * stays valid for the lifetime of the program.
+ *
+ * @param my_string The C-string to be encrypted.
+ *
+ * @code
+ * for (auto &row : rows)
+ *   row.write(XorStringCached("Hello, World!")); // decrypted once
+ * @endcode
+ *
+ * @note The C-string must be a string literal.
+ * @note The plaintext stays in memory once decrypted.
+ */
+#define XorStringCached(my_string)                                             \
+  [] {                                                                         \
+    static constexpr crypt::Xor_string<(sizeof(my_string) / sizeof(char)),    \
+                                       char>                                   \
+        expr(my_string);                                                       \
+    static crypt::Xor_string_cache<(sizeof(my_string) / sizeof(char)), char>   \
+        cache;                                                                 \
+    return cache.get(expr);                                                    \
+  }()
+
+
+/**
+ * @brief Alias for XorStringCached macro.
+ *
+ * @see XorStringCached
+ */
+#define _cc(string) XorStringCached(string)
+
+
+/**
+ * @brief Creates an anonymous compile-time encrypted wide C-string that is
+ * decrypted only once.
+ *
+ * @param my_string The wide C-string to be encrypted.
+ *
+ * @see XorStringCached
+ *
+ * @note The C-string must be a wide string literal.
+ * @note The plaintext stays in memory once decrypted.
+ */
+#define XorWideStringCached(my_string)                                         \
+  [] {                                                                         \
+    static constexpr crypt::Xor_string<(sizeof(my_string) / sizeof(wchar_t)), \
+                                       wchar_t>                                \
+        expr(my_string);                                                       \
+    static crypt::Xor_string_cache<(sizeof(my_string) / sizeof(wchar_t)),     \
+                                   wchar_t>                                    \
+        cache;                                                                 \
+    return cache.get(expr);                                                    \
+  }()
+
+
+/**
+ * @brief Alias for XorWideStringCached macro.
+ *
+ * @see XorWideStringCached
+ */
+#define _ccw(string) XorWideStringCached(string)
+
+
+/**
+ * @brief Creates an anonymous compile-time encrypted C-string and decrypts it
+ * at runtime into a std::string_view.
+ *
+ * Same as XorString, but the result carries the length of the literal, which
+ * is known at compile time, so consumers do not need to call strlen.
+ *
+ * @param my_string The C-string to be encrypted.
+ *
+ * @code
+ * std::cout << XorStringView("Hello") << '\n'; // size() == 5, no strlen
+ * std::string copy(XorStringView("Hello"));  // copied before the view dies
+ * @endcode
+ *
+ * @note The C-string must be a string literal.
+ * @note Like XorString, the view is only valid until the end of the
+ *       full-expression unless TBX_XSTR_CACHE is defined.
+ */
+#ifdef TBX_XSTR_CACHE
+#define XorStringView(my_string)                                               \
+  [] {                                                                         \
+    static constexpr crypt::Xor_string<(sizeof(my_string) / sizeof(char)),    \
+                                       char>                                   \
+        expr(my_string);                                                       \
+    static crypt::Xor_string_cache<(sizeof(my_string) / sizeof(char)), char>   \
+        cache;                                                                 \
+    return cache.get_view(expr);                                               \
+  }()
+#else
+#define XorStringView(my_string)                                               \
+  [] {                                                                         \
+    constexpr crypt::Xor_string<(sizeof(my_string) / sizeof(char)), char>      \
+        expr(my_string);                                                       \
+    return expr;                                                               \
+  }()                                                                          \
+      .decrypt_view()
+#endif
+
+
+/**
+ * @brief Alias for XorStringView macro.
+ *
+ * @see XorStringView
+ */
+#define _cv(string) XorStringView(string)
+
+
+/**
+ * @brief Creates an anonymous compile-time encrypted wide C-string and
+ * decrypts it at runtime into a std::wstring_view.
+ *
+ * @param my_string The wide C-string to be encrypted.
+ *
+ * @see XorStringView
+ *
+ * @note The C-string must be a wide string literal.
+ */
+#ifdef TBX_XSTR_CACHE
+#define XorWideStringView(my_string)                                           \
+  [] {                                                                         \
+    static constexpr crypt::Xor_string<(sizeof(my_string) / sizeof(wchar_t)), \
+                                       wchar_t>                                \
+        expr(my_string);                                                       \
+    static crypt::Xor_string_cache<(sizeof(my_string) / sizeof(wchar_t)),     \
+                                   wchar_t>                                    \
+        cache;                                                                 \
+    return cache.get_view(expr);                                               \
+  }()
+#else
+#define XorWideStringView(my_string)                                           \
+  [] {                                                                         \
+    constexpr crypt::Xor_string<(sizeof(my_string) / sizeof(wchar_t)),         \
+                                wchar_t>                                       \
+        expr(my_string);                                                       \
+    return expr;                                                               \
+  }()                                                                          \
+      .decrypt_view()
+#endif
+
+
+/**
+ * @brief Alias for XorWideStringView macro.
+ *
+ * @see XorWideStringView
+ */
+#define _cwv(string) XorWideStringView(string)
 
 
@@ -0,0 +1,595 @@
+/**
+ * @file   xor_aes.hpp
+ * @brief  This file provides an AES-128 counter-mode keystream policy for
+ *         crypt::Xor_string.
+ *
+ *         With crypt::Aes_ctr_keystream, literals are encrypted with a real
+ *         block cipher instead of an XOR ramp: byte p of the keystream is
+ *         byte (p % 16) of AES-128(XORAESKEY, XORAESNONCE || p / 16). The
+ *         encryption runs at compile time with a constexpr software AES.
+ *         At runtime the keystream comes from VAES or AES-NI, sixteen or
+ *         eight blocks in flight, when the CPU supports it. Otherwise a
+ *         portable implementation computes the S-box arithmetically, without
+ *         lookup tables, so its timing does not depend on the key or the
+ *         data.
+ *
+ *@note like every policy, the key is compiled into the program: this raises
+ *      the bar for static extraction, it does not protect against an attacker
+ *      who can run the binary.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/cstring_obfuscator.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+
+namespace crypt {
+namespace detail {
+// =============================================================================
+
+constexpr bool is_constant_evaluated() noexcept {
+#ifdef __cpp_lib_is_constant_evaluated
+  return std::is_constant_evaluated();
+#else
+  return __builtin_is_constant_evaluated();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// GF(2^8) arithmetic, branch-free and table-free
+
+constexpr std::uint8_t gf_xtime(std::uint8_t x) {
+  return static_cast<std::uint8_t>((x << 1) ^ (0x1B & -(x >> 7)));
+}
+
+// The functions below work on the 8 bytes of a 64-bit word at once.
+
+constexpr std::uint64_t bytes_of(std::uint8_t b) {
+  return 0x0101010101010101ull * b;
+}
+
+constexpr std::uint64_t gf_xtime8(std::uint64_t x) {
+  return ((x & bytes_of(0x7F)) << 1) ^ (((x >> 7) & bytes_of(1)) * 0x1B);
+}
+
+constexpr std::uint64_t gf_mul8(std::uint64_t a, std::uint64_t b) {
+  std::uint64_t r = 0;
+  for (int i = 0; i < 8; ++i, b >>= 1) {
+    r ^= a & ((b & bytes_of(1)) * 0xFF);
+    a = gf_xtime8(a);
+  }
+  return r;
+}
+
+constexpr std::uint64_t rotl8x8(std::uint64_t x, int n) {
+  return ((x << n) & bytes_of(static_cast<std::uint8_t>(0xFF << n))) |
+         ((x >> (8 - n)) & bytes_of(static_cast<std::uint8_t>(0xFF >> (8 - n))));
+}
+
+// @return the AES S-box of each byte of @p x, computed as the affine
+//         transform of x^254
+constexpr std::uint64_t aes_sbox8(std::uint64_t x) {
+  // x^254 == x^-1 for x != 0, and 0 for x == 0.
+  std::uint64_t x2 = gf_mul8(x, x);
+  std::uint64_t inv = x2;
+  for (int i = 0; i < 6; ++i) {
+    x2 = gf_mul8(x2, x2);
+    inv = gf_mul8(inv, x2);
+  }
+  return inv ^ rotl8x8(inv, 1) ^ rotl8x8(inv, 2) ^ rotl8x8(inv, 3) ^
+         rotl8x8(inv, 4) ^ bytes_of(0x63);
+}
+
+constexpr std::array<std::uint8_t, 256> make_aes_sbox() {
+  std::array<std::uint8_t, 256> sbox{};
+  for (unsigned i = 0; i < 256; ++i)
+    sbox[i] = static_cast<std::uint8_t>(aes_sbox8(i));
+  return sbox;
+}
+
+// Only ever indexed during constant evaluation, where timing is irrelevant.
+inline constexpr std::array<std::uint8_t, 256> aes_sbox = make_aes_sbox();
+
+// -----------------------------------------------------------------------------
+// AES-128 (FIPS-197)
+
+struct aes128_key {
+  // The 11 round keys.
+  alignas(16) std::uint8_t rk[11][16];
+  // The same round keys as little-endian column words.
+  std::uint32_t words[11][4];
+};
+
+using aes_block = std::array<std::uint8_t, 16>;
+
+constexpr aes128_key aes128_expand(const aes_block &key) {
+  std::uint8_t w[176] = {};
+  for (int i = 0; i < 16; ++i)
+    w[i] = key[i];
+  std::uint8_t rcon = 1;
+  for (int i = 16; i < 176; i += 4) {
+    std::uint8_t t[4] = {w[i - 4], w[i - 3], w[i - 2], w[i - 1]};
+    if (i % 16 == 0) {
+      const std::uint8_t t0 = t[0];
+      t[0] = static_cast<std::uint8_t>(aes_sbox[t[1]] ^ rcon);
+      t[1] = aes_sbox[t[2]];
+      t[2] = aes_sbox[t[3]];
+      t[3] = aes_sbox[t0];
+      rcon = gf_xtime(rcon);
+    }
+    for (int j = 0; j < 4; ++j)
+      w[i + j] = static_cast<std::uint8_t>(w[i - 16 + j] ^ t[j]);
+  }
+  aes128_key expanded{};
+  for (int r = 0; r < 11; ++r)
+    for (int j = 0; j < 16; ++j) {
+      expanded.rk[r][j] = w[16 * r + j];
+      expanded.words[r][j / 4] |= std::uint32_t{w[16 * r + j]}
+                                  << (8 * (j % 4));
+    }
+  return expanded;
+}
+
+// T-tables: SubBytes and MixColumns of one byte of row r, as the column
+// rotl({2 S[x], S[x], S[x], 3 S[x]}, 8 r) packed little-endian.
+constexpr std::array<std::array<std::uint32_t, 256>, 4> make_aes_te() {
+  std::array<std::array<std::uint32_t, 256>, 4> te{};
+  for (unsigned i = 0; i < 256; ++i) {
+    const std::uint32_t s = aes_sbox[i];
+    const std::uint32_t s2 = gf_xtime(aes_sbox[i]);
+    const std::uint32_t column = s2 | (s << 8) | (s << 16) | ((s2 ^ s) << 24);
+    for (int r = 0; r < 4; ++r)
+      te[r][i] = r ? (column << (8 * r)) | (column >> (32 - 8 * r)) : column;
+  }
+  return te;
+}
+
+inline constexpr std::array<std::array<std::uint32_t, 256>, 4> aes_te =
+    make_aes_te();
+
+// Table-driven AES for constant evaluation, on the four little-endian column
+// words of the state: a round is 16 lookups and a few xors instead of
+// byte-wise SubBytes and MixColumns, which keeps large literals within the
+// default constexpr operation limits.
+constexpr void aes128_encrypt_words(const aes128_key &key,
+                                    std::uint32_t (&w)[4]) {
+  for (int c = 0; c < 4; ++c)
+    w[c] ^= key.words[0][c];
+  for (int round = 1; round < 10; ++round) {
+    // ShiftRows: row r of column c comes from column c + r.
+    const std::uint32_t t0 = aes_te[0][w[0] & 0xFF] ^
+                             aes_te[1][(w[1] >> 8) & 0xFF] ^
+                             aes_te[2][(w[2] >> 16) & 0xFF] ^
+                             aes_te[3][w[3] >> 24] ^ key.words[round][0];
+    const std::uint32_t t1 = aes_te[0][w[1] & 0xFF] ^
+                             aes_te[1][(w[2] >> 8) & 0xFF] ^
+                             aes_te[2][(w[3] >> 16) & 0xFF] ^
+                             aes_te[3][w[0] >> 24] ^ key.words[round][1];
+    const std::uint32_t t2 = aes_te[0][w[2] & 0xFF] ^
+                             aes_te[1][(w[3] >> 8) & 0xFF] ^
+                             aes_te[2][(w[0] >> 16) & 0xFF] ^
+                             aes_te[3][w[1] >> 24] ^ key.words[round][2];
+    const std::uint32_t t3 = aes_te[0][w[3] & 0xFF] ^
+                             aes_te[1][(w[0] >> 8) & 0xFF] ^
+                             aes_te[2][(w[1] >> 16) & 0xFF] ^
+                             aes_te[3][w[2] >> 24] ^ key.words[round][3];
+    w[0] = t0;
+    w[1] = t1;
+    w[2] = t2;
+    w[3] = t3;
+  }
+  std::uint32_t t[4] = {};
+  for (int c = 0; c < 4; ++c)
+    for (int r = 0; r < 4; ++r)
+      t[c] |= std::uint32_t{aes_sbox[(w[(c + r) % 4] >> (8 * r)) & 0xFF]}
+              << (8 * r);
+  for (int c = 0; c < 4; ++c)
+    w[c] = t[c] ^ key.words[10][c];
+}
+
+/**
+ * @brief Encrypts one block in software.
+ *
+ * @tparam table Use the lookup tables, for constant evaluation. Otherwise
+ *               compute the S-box, which keeps the runtime fallback free of
+ *               key- and data-dependent memory accesses.
+ */
+template <bool table>
+constexpr aes_block aes128_encrypt(const aes128_key &key, aes_block s) {
+  if constexpr (table) {
+    std::uint32_t w[4] = {};
+    for (int j = 0; j < 16; ++j)
+      w[j / 4] |= std::uint32_t{s[j]} << (8 * (j % 4));
+    aes128_encrypt_words(key, w);
+    for (int j = 0; j < 16; ++j)
+      s[j] = static_cast<std::uint8_t>(w[j / 4] >> (8 * (j % 4)));
+    return s;
+  }
+  for (int j = 0; j < 16; ++j)
+    s[j] ^= key.rk[0][j];
+  for (int round = 1; round <= 10; ++round) {
+    // SubBytes, eight bytes at a time.
+    for (int half = 0; half < 16; half += 8) {
+      std::uint64_t x = 0;
+      for (int j = 0; j < 8; ++j)
+        x |= std::uint64_t{s[half + j]} << (8 * j);
+      x = aes_sbox8(x);
+      for (int j = 0; j < 8; ++j)
+        s[half + j] = static_cast<std::uint8_t>(x >> (8 * j));
+    }
+    // ShiftRows; byte j is row j % 4 of column j / 4.
+    aes_block t{};
+    for (int c = 0; c < 4; ++c)
+      for (int r = 0; r < 4; ++r)
+        t[c * 4 + r] = s[((c + r) % 4) * 4 + r];
+    if (round != 10)
+      for (int c = 0; c < 4; ++c) {
+        const std::uint8_t a0 = t[c * 4], a1 = t[c * 4 + 1],
+                           a2 = t[c * 4 + 2], a3 = t[c * 4 + 3];
+        const std::uint8_t all = static_cast<std::uint8_t>(a0 ^ a1 ^ a2 ^ a3);
+        t[c * 4] ^= static_cast<std::uint8_t>(all ^ gf_xtime(a0 ^ a1));
+        t[c * 4 + 1] ^= static_cast<std::uint8_t>(all ^ gf_xtime(a1 ^ a2));
+        t[c * 4 + 2] ^= static_cast<std::uint8_t>(all ^ gf_xtime(a2 ^ a3));
+        t[c * 4 + 3] ^= static_cast<std::uint8_t>(all ^ gf_xtime(a3 ^ a0));
+      }
+    for (int j = 0; j < 16; ++j)
+      s[j] = static_cast<std::uint8_t>(t[j] ^ key.rk[round][j]);
+  }
+  return s;
+}
+
+// @return the counter block of keystream block @p index: the nonce in
+//         little-endian order followed by the index in big-endian order
+constexpr aes_block aes_ctr_counter(std::uint64_t nonce, std::uint64_t index) {
+  aes_block b{};
+  for (int i = 0; i < 8; ++i) {
+    b[i] = static_cast<std::uint8_t>(nonce >> (8 * i));
+    b[8 + i] = static_cast<std::uint8_t>(index >> (56 - 8 * i));
+  }
+  return b;
+}
+
+/**
+ * @brief Applies the AES-CTR keystream to a range of characters with the
+ *        software AES; one block is encrypted per 16 bytes.
+ *
+ * Character i takes the keystream bytes [i * sizeof(Char),
+ * (i + 1) * sizeof(Char)) in little-endian order.
+ *
+ * @tparam table See aes128_encrypt; false for the runtime fallback.
+ * @param pos Absolute index of src[0] inside the obfuscated string.
+ *
+ * @see xor_keystream_scalar
+ */
+template <bool table, typename Char>
+constexpr void aes_ctr_software(Char *dst, const Char *src, std::size_t n,
+                                const aes128_key &key, std::uint64_t nonce,
+                                std::size_t pos) {
+  using Unsigned = std::make_unsigned_t<Char>;
+  aes_block ks{};
+  std::size_t block = ~std::size_t{0};
+  for (std::size_t i = 0; i < n; ++i) {
+    Unsigned value = 0;
+    for (std::size_t b = 0; b < sizeof(Char); ++b) {
+      const std::size_t p = (pos + i) * sizeof(Char) + b;
+      if (p / 16 != block) {
+        block = p / 16;
+        ks = aes128_encrypt<table>(key, aes_ctr_counter(nonce, block));
+      }
+      value |= static_cast<Unsigned>(static_cast<Unsigned>(ks[p % 16])
+                                     << (8 * b));
+    }
+    dst[i] = static_cast<Char>(src[i] ^ value);
+  }
+}
+
+constexpr std::uint32_t bswap32(std::uint32_t x) {
+  return (x >> 24) | ((x >> 8) & 0xFF00) | ((x << 8) & 0xFF0000) | (x << 24);
+}
+
+/**
+ * @brief Compile-time counterpart of aes_ctr_software(), working on whole
+ *        keystream blocks as column words.
+ *
+ * @param pos Absolute index of src[0], a multiple of 16 / sizeof(Char).
+ */
+template <typename Char>
+constexpr void aes_ctr_table(Char *dst, const Char *src, std::size_t n,
+                             const aes128_key &key, std::uint64_t nonce,
+                             std::size_t pos) {
+  if constexpr (4 % sizeof(Char) != 0) {
+    aes_ctr_software<true>(dst, src, n, key, nonce, pos);
+  } else {
+    constexpr std::size_t per_word = 4 / sizeof(Char);
+    constexpr std::size_t per_block = 4 * per_word;
+    for (std::size_t i = 0; i < n;) {
+      const std::uint64_t index = (pos + i) / per_block;
+      // aes_ctr_counter() as column words.
+      std::uint32_t w[4] = {static_cast<std::uint32_t>(nonce),
+                            static_cast<std::uint32_t>(nonce >> 32),
+                            bswap32(static_cast<std::uint32_t>(index >> 32)),
+                            bswap32(static_cast<std::uint32_t>(index))};
+      aes128_encrypt_words(key, w);
+      for (std::size_t j = 0; j < per_block && i < n; ++j, ++i)
+        dst[i] = static_cast<Char>(
+            src[i] ^ static_cast<Char>(w[j / per_word] >>
+                                       (8 * sizeof(Char) * (j % per_word))));
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+#ifdef TBX_XSTR_X86_KERNELS
+
+__attribute__((target("aes"))) inline __m128i
+aes_ctr_block_aesni(const __m128i (&rk)[11], std::uint64_t nonce,
+                    std::uint64_t index) {
+  __m128i x = _mm_xor_si128(
+      _mm_set_epi64x(static_cast<long long>(__builtin_bswap64(index)),
+                     static_cast<long long>(nonce)),
+      rk[0]);
+  for (int r = 1; r < 10; ++r)
+    x = _mm_aesenc_si128(x, rk[r]);
+  return _mm_aesenclast_si128(x, rk[10]);
+}
+
+// Byte-level AES-NI kernel: @p p is the byte position of src[0]. Handles the
+// whole range, partial blocks included, and returns n.
+__attribute__((target("aes"))) inline std::size_t
+aes_ctr_aesni(std::uint8_t *dst, const std::uint8_t *src, std::size_t n,
+              const aes128_key &key, std::uint64_t nonce, std::size_t p) {
+  __m128i rk[11];
+  for (int r = 0; r < 11; ++r)
+    rk[r] = _mm_load_si128(reinterpret_cast<const __m128i *>(key.rk[r]));
+  alignas(16) std::uint8_t ks[16];
+  std::size_t i = 0;
+  if (p % 16) {
+    _mm_store_si128(reinterpret_cast<__m128i *>(ks),
+                    aes_ctr_block_aesni(rk, nonce, p / 16));
+    for (; i < n && (p + i) % 16; ++i)
+      dst[i] = static_cast<std::uint8_t>(src[i] ^ ks[(p + i) % 16]);
+  }
+  std::uint64_t index = (p + i) / 16;
+  // Eight independent blocks hide the latency of aesenc.
+  for (; i + 128 <= n; i += 128, index += 8) {
+    __m128i x[8];
+    for (int b = 0; b < 8; ++b)
+      x[b] = _mm_xor_si128(
+          _mm_set_epi64x(static_cast<long long>(__builtin_bswap64(index + b)),
+                         static_cast<long long>(nonce)),
+          rk[0]);
+    for (int r = 1; r < 10; ++r)
+      for (int b = 0; b < 8; ++b)
+        x[b] = _mm_aesenc_si128(x[b], rk[r]);
+    for (int b = 0; b < 8; ++b) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16 * b));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 16 * b),
+                       _mm_xor_si128(v, _mm_aesenclast_si128(x[b], rk[10])));
+    }
+  }
+  for (; i + 16 <= n; i += 16, ++index) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_xor_si128(v, aes_ctr_block_aesni(rk, nonce, index)));
+  }
+  if (i < n) {
+    _mm_store_si128(reinterpret_cast<__m128i *>(ks),
+                    aes_ctr_block_aesni(rk, nonce, index));
+    for (std::size_t j = 0; i < n; ++i, ++j)
+      dst[i] = static_cast<std::uint8_t>(src[i] ^ ks[j]);
+  }
+  return n;
+}
+
+// Same as aes_ctr_aesni with VAES: four blocks per 512-bit register and
+// sixteen in flight. The last 256 bytes at most go through aes_ctr_aesni.
+__attribute__((target("vaes,avx512f"))) inline std::size_t
+aes_ctr_vaes(std::uint8_t *dst, const std::uint8_t *src, std::size_t n,
+             const aes128_key &key, std::uint64_t nonce, std::size_t p) {
+  std::size_t i = 0;
+  if (p % 16) {
+    i = 16 - p % 16 < n ? 16 - p % 16 : n;
+    aes_ctr_aesni(dst, src, i, key, nonce, p);
+  }
+  // maskz: the unmasked broadcast trips -Wuninitialized in GCC 12 headers.
+  __m512i rk[11];
+  for (int r = 0; r < 11; ++r)
+    rk[r] = _mm512_maskz_broadcast_i32x4(
+        0xFFFF, _mm_load_si128(reinterpret_cast<const __m128i *>(key.rk[r])));
+  const long long lo = static_cast<long long>(nonce);
+  std::uint64_t index = (p + i) / 16;
+  for (; i + 256 <= n; i += 256, index += 16) {
+    __m512i x[4];
+    for (int b = 0; b < 4; ++b) {
+      const std::uint64_t k = index + 4 * b;
+      x[b] = _mm512_xor_si512(
+          _mm512_set_epi64(static_cast<long long>(__builtin_bswap64(k + 3)),
+                           lo,
+                           static_cast<long long>(__builtin_bswap64(k + 2)),
+                           lo,
+                           static_cast<long long>(__builtin_bswap64(k + 1)),
+                           lo, static_cast<long long>(__builtin_bswap64(k)),
+                           lo),
+          rk[0]);
+    }
+    for (int r = 1; r < 10; ++r)
+      for (int b = 0; b < 4; ++b)
+        x[b] = _mm512_aesenc_epi128(x[b], rk[r]);
+    for (int b = 0; b < 4; ++b)
+      _mm512_storeu_si512(
+          dst + i + 64 * b,
+          _mm512_xor_si512(_mm512_loadu_si512(src + i + 64 * b),
+                           _mm512_aesenclast_epi128(x[b], rk[10])));
+  }
+  return i + aes_ctr_aesni(dst + i, src + i, n - i, key, nonce, p + i);
+}
+
+using aes_ctr_fn = std::size_t (*)(std::uint8_t *, const std::uint8_t *,
+                                   std::size_t, const aes128_key &,
+                                   std::uint64_t, std::size_t);
+
+inline std::size_t aes_ctr_none(std::uint8_t *, const std::uint8_t *,
+                                std::size_t, const aes128_key &, std::uint64_t,
+                                std::size_t) {
+  return 0;
+}
+
+inline aes_ctr_fn select_aes_ctr() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f"))
+    return &aes_ctr_vaes;
+  if (__builtin_cpu_supports("aes"))
+    return &aes_ctr_aesni;
+  return &aes_ctr_none;
+}
+
+inline std::size_t aes_ctr_resolve(std::uint8_t *dst, const std::uint8_t *src,
+                                   std::size_t n, const aes128_key &key,
+                                   std::uint64_t nonce, std::size_t p);
+
+// Same lazy resolution as xor_keystream_impl.
+inline std::atomic<aes_ctr_fn> aes_ctr_impl{&aes_ctr_resolve};
+
+inline std::size_t aes_ctr_resolve(std::uint8_t *dst, const std::uint8_t *src,
+                                   std::size_t n, const aes128_key &key,
+                                   std::uint64_t nonce, std::size_t p) {
+  const aes_ctr_fn kernel = select_aes_ctr();
+  aes_ctr_impl.store(kernel, std::memory_order_relaxed);
+  return kernel(dst, src, n, key, nonce, p);
+}
+
+#endif // TBX_XSTR_X86_KERNELS
+
+/**
+ * @brief Applies the AES-CTR keystream with AES-NI when the running CPU has
+ *        it, and with the table-free software AES otherwise.
+ *
+ * @see aes_ctr_software
+ */
+template <typename Char>
+inline void aes_ctr(Char *dst, const Char *src, std::size_t n,
+                    const aes128_key &key, std::uint64_t nonce,
+                    std::size_t pos = 0) {
+#ifdef TBX_XSTR_X86_KERNELS
+  if constexpr (has_simd_lanes<Char>) {
+    auto *d = reinterpret_cast<std::uint8_t *>(dst);
+    auto *s = reinterpret_cast<const std::uint8_t *>(src);
+#if defined(__VAES__) && defined(__AVX512F__)
+    aes_ctr_vaes(d, s, n * sizeof(Char), key, nonce, pos * sizeof(Char));
+    return;
+#elif defined(__AES__)
+    aes_ctr_aesni(d, s, n * sizeof(Char), key, nonce, pos * sizeof(Char));
+    return;
+#else
+    if (aes_ctr_impl.load(std::memory_order_relaxed)(
+            d, s, n * sizeof(Char), key, nonce, pos * sizeof(Char)))
+      return;
+#endif
+  }
+#endif
+  aes_ctr_software<false>(dst, src, n, key, nonce, pos);
+}
+
+/**
+ * @brief Compares a probe with a range encrypted with the AES-CTR keystream,
+ *        in the encrypted domain.
+ *
+ * @see counter_keystream_equal
+ */
+template <typename Char>
+inline bool aes_ctr_equal(const Char *encrypted, const Char *probe,
+                          std::size_t n, const aes128_key &key,
+                          std::uint64_t nonce, std::size_t pos = 0) {
+  using Unsigned = std::make_unsigned_t<Char>;
+  constexpr std::size_t chunk = 256 / sizeof(Char);
+  Char ks[chunk];
+  Unsigned diff = 0;
+  for (std::size_t i = 0; i < n; i += chunk) {
+    const std::size_t len = n - i < chunk ? n - i : chunk;
+    aes_ctr(ks, probe + i, len, key, nonce, pos + i);
+    for (std::size_t j = 0; j < len; ++j)
+      diff |= static_cast<Unsigned>(ks[j] ^ encrypted[i + j]);
+  }
+  return diff == 0;
+}
+
+constexpr aes_block aes_key_from_seed() {
+  aes_block key{};
+  for (unsigned w = 0; w < 4; ++w) {
+    const unsigned long long r = linear_congruent_generator(30 + w);
+    for (unsigned b = 0; b < 4; ++b)
+      key[4 * w + b] = static_cast<std::uint8_t>(r >> (8 * b));
+  }
+  return key;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+
+// AES-128 round keys of Aes_ctr_keystream, drawn from the same generator as
+// XORKEY.
+constexpr const detail::aes128_key XORAESKEY =
+    detail::aes128_expand(detail::aes_key_from_seed());
+
+constexpr const std::uint64_t XORAESNONCE =
+    (linear_congruent_generator(40) << 32) ^ linear_congruent_generator(41);
+
+/**
+ * @brief AES-128 counter-mode keystream policy.
+ *
+ * An order of magnitude slower per byte than the ramp with VAES/AES-NI, and
+ * several hundred times slower with the portable fallback, so reserve it for
+ * the literals that warrant it.
+ *
+ * @code
+ * constexpr crypt::Xor_string<sizeof("api-key"), char, crypt::Aes_ctr_keystream>
+ *     api_key("api-key");
+ * @endcode
+ */
+struct Aes_ctr_keystream {
+  template <typename Char> static constexpr Char at(std::size_t i) {
+    Char ks = Char();
+    if (detail::is_constant_evaluated())
+      detail::aes_ctr_software<true>(&ks, &ks, 1, XORAESKEY, XORAESNONCE, i);
+    else
+      apply(&ks, &ks, 1, i);
+    return ks;
+  }
+
+  template <typename Char>
+  static constexpr void encrypt(Char *dst, const Char *src, std::size_t n) {
+    if (!detail::is_constant_evaluated()) {
+      apply(dst, src, n, 0);
+      return;
+    }
+    for (std::size_t pos = 0; pos < n; pos += detail::constexpr_chunk)
+      detail::aes_ctr_table(dst + pos, src + pos,
+                            detail::constexpr_chunk_end(pos, n) - pos,
+                            XORAESKEY, XORAESNONCE, pos);
+  }
+
+  template <typename Char>
+  static void apply(Char *dst, const Char *src, std::size_t n,
+                    std::size_t pos) {
+    detail::aes_ctr<Char>(dst, src, n, XORAESKEY, XORAESNONCE, pos);
+  }
+
+  template <typename Char>
+  static bool equal(const Char *encrypted, const Char *probe, std::size_t n,
+                    std::size_t pos) {
+    return detail::aes_ctr_equal<Char>(encrypted, probe, n, XORAESKEY,
+                                       XORAESNONCE, pos);
+  }
+};
+
+} // namespace crypt
@@ -0,0 +1,143 @@
+/**
+ * @file   xor_blob.hpp
+ * @brief  This file provides compile-time obfuscation of binary payloads
+ *         (certificates, configuration, model weights, ...) and a streaming
+ *         API that decrypts them chunk by chunk at runtime.
+ *
+ *         A crypt::Xor_blob holds std::byte data encrypted with the same
+ *         position-indexed keystream as crypt::Xor_string. Large payloads do
+ *         not need to be decrypted into one heap buffer: a
+ *         crypt::Xor_blob_stream hands them out in caller-sized pieces, so a
+ *         consumer can work through a blob in L1/L2-sized chunks.
+ *
+ *         The payload is encrypted by the compiler, which bounds its size:
+ *         with GCC's default -fconstexpr-ops-limit 512 KiB builds and 1 MiB
+ *         does not (Clang has -fconstexpr-steps). Pack larger resources with
+ *         tools/xorpack and read them with crypt::Xor_pack (xor_pack.hpp).
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/cstring_obfuscator.hpp>
+
+#include <cstddef>
+#if __has_include(<span>)
+#include <span>
+#endif
+
+
+namespace crypt {
+// =============================================================================
+
+/**
+ * @brief Sequential reader over an encrypted byte range.
+ *
+ * The stream only refers to the encrypted bytes; every chunk is decrypted
+ * into the buffer passed to next_chunk(). Since the keystream depends only on
+ * the position, seek() is free.
+ */
+class Xor_blob_stream {
+public:
+  using value_type = std::byte;
+
+  // Chunk size that fits comfortably in the L1/L2 cache of current CPUs.
+  static constexpr std::size_t default_chunk = 16 * 1024;
+
+  constexpr Xor_blob_stream(const std::byte *encrypted, std::size_t size)
+      : _data(encrypted), _size(size), _pos(0) {}
+
+  constexpr std::size_t size() const { return _size; }
+  constexpr std::size_t position() const { return _pos; }
+  constexpr std::size_t remaining() const { return _size - _pos; }
+  constexpr bool done() const { return _pos == _size; }
+
+  // Moves to byte @p pos, clamped to the end of the payload.
+  void seek(std::size_t pos) { _pos = pos < _size ? pos : _size; }
+
+  /**
+   * @brief Decrypts the next chunk of the payload.
+   *
+   * @param out      Destination buffer.
+   * @param capacity Size of @p out in bytes.
+   * @return the number of bytes written to @p out, 0 once the payload is
+   *         exhausted
+   */
+  std::size_t next_chunk(std::byte *out, std::size_t capacity) {
+    const std::size_t n = capacity < remaining() ? capacity : remaining();
+    detail::xor_keystream<unsigned char>(
+        reinterpret_cast<unsigned char *>(out),
+        reinterpret_cast<const unsigned char *>(_data + _pos), n,
+        static_cast<unsigned char>(XORKEY), _pos);
+    _pos += n;
+    return n;
+  }
+
+#ifdef __cpp_lib_span
+  // @return the part of @p out filled with the next chunk, empty at the end
+  std::span<std::byte> next_chunk(std::span<std::byte> out) {
+    return out.first(next_chunk(out.data(), out.size()));
+  }
+#endif
+
+private:
+  const std::byte *_data;
+  std::size_t _size;
+  std::size_t _pos;
+};
+
+// -----------------------------------------------------------------------------
+
+template <std::size_t size> class Xor_blob {
+public:
+  static constexpr std::size_t _nb_bytes = size;
+  std::byte _data[size];
+
+  // if every goes alright this constructor should be executed at compile time
+  constexpr Xor_blob(const unsigned char (&bytes)[size]) : _data{} {
+    for (std::size_t pos = 0; pos < size; pos += detail::constexpr_chunk)
+      for (std::size_t i = pos, end = detail::constexpr_chunk_end(pos, size);
+           i < end; ++i)
+        _data[i] = static_cast<std::byte>(
+            bytes[i] ^ static_cast<unsigned char>(XORKEY + i));
+  }
+
+  // @return a stream decrypting the payload from the start
+  constexpr Xor_blob_stream stream() const { return {_data, size}; }
+
+  /**
+   * @brief Decrypts @p n bytes starting at @p pos into @p out.
+   *
+   * Like Xor_string::decrypt_range, the range is clamped to the end of the
+   * payload.
+   *
+   * @return the number of bytes written to @p out
+   */
+  std::size_t decrypt_range(std::size_t pos, std::size_t n,
+                            std::byte *out) const {
+    Xor_blob_stream s = stream();
+    s.seek(pos);
+    return s.next_chunk(out, n);
+  }
+};
+
+} // namespace crypt
+
+
+/**
+ * @brief Creates a named compile-time encrypted binary payload.
+ *
+ * @param name  The variable name for the crypt::Xor_blob instance.
+ * @param bytes A constexpr array of unsigned char, e.g. generated by xxd -i;
+ *              at most a few hundred KiB, see the limits in the file brief.
+ *
+ * @code
+ * constexpr unsigned char cert_der[] = {0x30, 0x82, 0x03, ...};
+ * XorBlob(cert, cert_der);
+ *
+ * std::byte chunk[crypt::Xor_blob_stream::default_chunk];
+ * auto s = cert.stream();
+ * while (std::size_t n = s.next_chunk(chunk, sizeof(chunk)))
+ *   parser.feed(chunk, n);
+ * @endcode
+ */
+#define XorBlob(name, bytes) constexpr crypt::Xor_blob name{bytes}
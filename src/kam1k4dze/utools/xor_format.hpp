@@ -0,0 +1,115 @@
+/**
+ * @file   xor_format.hpp
+ * @brief  This file provides std::format and {fmt} formatting with obfuscated
+ *         format strings.
+ *
+ *         XorFormatTo validates the format string against the argument types
+ *         at compile time, on the plaintext and before it is encrypted, like
+ *         std::format_to does for a literal. Only the encrypted
+ *         crypt::Xor_string reaches the binary. At runtime the format is
+ *         decrypted into a stack buffer whose size is known at compile time
+ *         and the output is written straight to the caller's output
+ *         iterator: no heap allocation on the way.
+ *
+ *@note needs C++20. Uses <format> when the standard library provides it;
+ *      define TBX_XSTR_FMT before including this file to use {fmt} instead.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/cstring_obfuscator.hpp>
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#if defined(TBX_XSTR_FMT)
+#include <fmt/format.h>
+#elif __has_include(<format>)
+#include <format>
+#endif
+
+#if !defined(__cpp_consteval)
+#error "xor_format.hpp needs C++20 consteval"
+#elif !defined(TBX_XSTR_FMT) && !defined(__cpp_lib_format)
+#error "xor_format.hpp needs <format>; define TBX_XSTR_FMT to use {fmt}"
+#else
+
+
+namespace crypt {
+// =============================================================================
+namespace detail {
+
+#if defined(TBX_XSTR_FMT)
+namespace format_backend = ::fmt;
+#else
+namespace format_backend = ::std;
+#endif
+
+template <class Tuple> struct xor_format_checker;
+
+// Names the argument types of a call in an unevaluated operand. Unlike
+// class template argument deduction of std::tuple, a single std::pair or
+// std::tuple argument stays one argument.
+template <typename... Args>
+std::tuple<Args...> xor_format_types(const Args &...);
+
+// The argument types come as the tuple type of the call's arguments, so the
+// macro can name them without evaluating the arguments.
+template <typename... Args> struct xor_format_checker<std::tuple<Args...>> {
+  template <std::size_t size>
+  static consteval bool check(const char (&format)[size]) {
+    // Rejects invalid formats and mismatched arguments at compile time.
+    format_backend::format_string<const Args &...> checked(format);
+    (void)checked;
+    return true;
+  }
+};
+
+/**
+ * Formats @p args into @p out with the format string @p format. The format is
+ * not checked: use XorFormatTo.
+ */
+template <typename Out, unsigned size, class Keystream, typename... Args>
+Out xor_format_to(Out out, const Xor_string<size, char, Keystream> &format,
+                  const Args &...args) {
+  char plain[size];
+  format.decrypt_to(plain);
+  return format_backend::vformat_to(
+      std::move(out), std::string_view(plain, size - 1),
+      format_backend::make_format_args(args...));
+}
+
+} // namespace detail
+} // namespace crypt
+
+
+/**
+ * @brief Formats the arguments into an output iterator with a compile-time
+ * encrypted format string.
+ *
+ * @param out    Output iterator of char, for instance a pointer into a stack
+ *               buffer or std::back_inserter of a reserved string.
+ * @param format The format string; must be a string literal.
+ * @return the iterator past the last character written
+ *
+ * @code
+ * char line[128];
+ * char *end = XorFormatTo(line, "user {} logged in from {}:{}", id, ip, port);
+ * @endcode
+ *
+ * @note A mismatch between the format and the arguments is a compile error.
+ */
+#define XorFormatTo(out, format, ...)                                          \
+  crypt::detail::xor_format_to(                                                \
+      out,                                                                     \
+      []() -> const auto & {                                                   \
+        static_assert(crypt::detail::xor_format_checker<decltype(             \
+                          crypt::detail::xor_format_types(__VA_ARGS__))>::     \
+                          check(format));                                      \
+        static constexpr crypt::Xor_string<sizeof(format), char> expr(format); \
+        return expr;                                                           \
+      }() __VA_OPT__(, ) __VA_ARGS__)
+
+#endif
@@ -0,0 +1,794 @@
+/**
+ * @file   xor_kernel.hpp
+ * @brief  This file provides the runtime XOR keystream kernels used by
+ *         cstring_obfuscator.hpp to decrypt obfuscated strings.
+ *
+ *         The default keystream of an obfuscated string is the ramp
+ *         (key + index) truncated to the width of the character type. The
+ *         counter-mode keystream hashes a 32-bit counter per 4 bytes instead.
+ *         For both, the kernels below build the keystream directly in a
+ *         vector register and process 16, 32 or 64 bytes per iteration with
+ *         SSE2/SSE4.1, AVX2 or AVX-512, falling back to the plain scalar loop
+ *         for the tail and on other architectures.
+ *         The vector kernel is selected once at runtime from the CPU
+ *         features, so the header does not need to be built with -mavx2.
+ *
+ *@note define TBX_XSTR_NO_SIMD before including this file to force the scalar
+ *      kernel everywhere
+ * @date   October 2026
+ */
+#pragma once
+
+// POSIX <unistd.h>, which libstdc++ pulls in from <atomic>, <thread> or
+// <memory> in C++20, declares a ::crypt() function that collides with
+// namespace crypt. Include it first with that declaration renamed so the
+// include guard keeps it out of every later standard header.
+// NOTE: in every translation unit that includes this file, the POSIX
+// function is therefore declared as ::crypt_posix(); call it by that name.
+// For the same reason <unistd.h> must not be included before the first
+// header of this library.
+#if __has_include(<unistd.h>)
+#define crypt crypt_posix
+#include <unistd.h>
+#undef crypt
+#endif
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if !defined(TBX_XSTR_NO_SIMD) && defined(__GNUC__) &&                         \
+    (defined(__x86_64__) || defined(__i386__))
+#define TBX_XSTR_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+
+namespace crypt {
+namespace detail {
+// =============================================================================
+
+/**
+ * @brief Applies the obfuscation keystream to a range of characters.
+ *
+ * Character i of the range is XORed with (key + pos + i), which is exactly
+ * what encrypt_character() does for the character at absolute index pos + i.
+ * Because XOR is its own inverse the same kernel encrypts and decrypts.
+ * @p dst and @p src may be the same pointer.
+ *
+ * @param dst Output characters.
+ * @param src Input characters.
+ * @param n   Number of characters to process.
+ * @param key Keystream base, usually static_cast<Char>(XORKEY).
+ * @param pos Absolute index of src[0] inside the obfuscated string.
+ */
+template <typename Char>
+inline void xor_keystream_scalar(Char *dst, const Char *src, std::size_t n,
+                                 Char key, std::size_t pos) {
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = static_cast<Char>(src[i] ^ static_cast<Char>(key + pos + i));
+}
+
+/**
+ * @brief Checks whether @p probe matches the plaintext of an encrypted range,
+ *        without decrypting it.
+ *
+ * The probe is encrypted on the fly with the keystream (key + pos + i) and
+ * compared with @p encrypted. All @p n characters are always examined, so
+ * the running time does not depend on where the first mismatch is.
+ *
+ * @return true if all @p n characters match
+ */
+template <typename Char>
+inline bool xor_keystream_equal_scalar(const Char *encrypted, const Char *probe,
+                                       std::size_t n, Char key,
+                                       std::size_t pos) {
+  using Unsigned = std::make_unsigned_t<Char>;
+  Unsigned diff = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    diff |= static_cast<Unsigned>(encrypted[i] ^
+                                  static_cast<Char>(key + pos + i) ^ probe[i]);
+  return diff == 0;
+}
+
+// -----------------------------------------------------------------------------
+
+#ifdef TBX_XSTR_X86_KERNELS
+
+// Unsigned integer lane matching the width of Char.
+template <typename Char>
+using lane_t = std::conditional_t<
+    sizeof(Char) == 1, std::uint8_t,
+    std::conditional_t<sizeof(Char) == 2, std::uint16_t, std::uint32_t>>;
+
+template <typename Char>
+inline constexpr bool has_simd_lanes =
+    sizeof(Char) == 1 || sizeof(Char) == 2 || sizeof(Char) == 4;
+
+template <typename Lane, std::size_t... I>
+constexpr std::array<Lane, sizeof...(I)> make_ramp(std::index_sequence<I...>) {
+  return {{static_cast<Lane>(I)...}};
+}
+
+// {0, 1, 2, ...} spanning one 512-bit register, loaded as the per-lane offset
+// of the keystream.
+template <typename Lane>
+alignas(64) inline constexpr std::array<Lane, 64 / sizeof(Lane)> ramp =
+    make_ramp<Lane>(std::make_index_sequence<64 / sizeof(Lane)>{});
+
+// -----------------------------------------------------------------------------
+
+// Keystream of one vector register: `ks` holds (key + pos + i) for each lane
+// and next() advances it to the following register.
+
+template <typename Char> struct sse2_keystream {
+  static constexpr std::size_t lanes = 16 / sizeof(Char);
+  __m128i ks, step;
+
+  __attribute__((target("sse2"))) sse2_keystream(Char key, std::size_t pos) {
+    const lane_t<Char> base = static_cast<lane_t<Char>>(key + pos);
+    ks = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(ramp<lane_t<Char>>.data()));
+    if constexpr (sizeof(Char) == 1) {
+      ks = _mm_add_epi8(ks, _mm_set1_epi8(static_cast<char>(base)));
+      step = _mm_set1_epi8(static_cast<char>(lanes));
+    } else if constexpr (sizeof(Char) == 2) {
+      ks = _mm_add_epi16(ks, _mm_set1_epi16(static_cast<short>(base)));
+      step = _mm_set1_epi16(static_cast<short>(lanes));
+    } else {
+      ks = _mm_add_epi32(ks, _mm_set1_epi32(static_cast<int>(base)));
+      step = _mm_set1_epi32(static_cast<int>(lanes));
+    }
+  }
+
+  __attribute__((target("sse2"))) void next() {
+    if constexpr (sizeof(Char) == 1)
+      ks = _mm_add_epi8(ks, step);
+    else if constexpr (sizeof(Char) == 2)
+      ks = _mm_add_epi16(ks, step);
+    else
+      ks = _mm_add_epi32(ks, step);
+  }
+};
+
+template <typename Char> struct avx2_keystream {
+  static constexpr std::size_t lanes = 32 / sizeof(Char);
+  __m256i ks, step;
+
+  __attribute__((target("avx2"))) avx2_keystream(Char key, std::size_t pos) {
+    const lane_t<Char> base = static_cast<lane_t<Char>>(key + pos);
+    ks = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(ramp<lane_t<Char>>.data()));
+    if constexpr (sizeof(Char) == 1) {
+      ks = _mm256_add_epi8(ks, _mm256_set1_epi8(static_cast<char>(base)));
+      step = _mm256_set1_epi8(static_cast<char>(lanes));
+    } else if constexpr (sizeof(Char) == 2) {
+      ks = _mm256_add_epi16(ks, _mm256_set1_epi16(static_cast<short>(base)));
+      step = _mm256_set1_epi16(static_cast<short>(lanes));
+    } else {
+      ks = _mm256_add_epi32(ks, _mm256_set1_epi32(static_cast<int>(base)));
+      step = _mm256_set1_epi32(static_cast<int>(lanes));
+    }
+  }
+
+  __attribute__((target("avx2"))) void next() {
+    if constexpr (sizeof(Char) == 1)
+      ks = _mm256_add_epi8(ks, step);
+    else if constexpr (sizeof(Char) == 2)
+      ks = _mm256_add_epi16(ks, step);
+    else
+      ks = _mm256_add_epi32(ks, step);
+  }
+};
+
+template <typename Char> struct avx512_keystream {
+  static constexpr std::size_t lanes = 64 / sizeof(Char);
+  __m512i ks, step;
+
+  __attribute__((target("avx512f,avx512bw")))
+  avx512_keystream(Char key, std::size_t pos) {
+    const lane_t<Char> base = static_cast<lane_t<Char>>(key + pos);
+    ks = _mm512_loadu_si512(ramp<lane_t<Char>>.data());
+    if constexpr (sizeof(Char) == 1) {
+      ks = _mm512_add_epi8(ks, _mm512_set1_epi8(static_cast<char>(base)));
+      step = _mm512_set1_epi8(static_cast<char>(lanes));
+    } else if constexpr (sizeof(Char) == 2) {
+      ks = _mm512_add_epi16(ks, _mm512_set1_epi16(static_cast<short>(base)));
+      step = _mm512_set1_epi16(static_cast<short>(lanes));
+    } else {
+      ks = _mm512_add_epi32(ks, _mm512_set1_epi32(static_cast<int>(base)));
+      step = _mm512_set1_epi32(static_cast<int>(lanes));
+    }
+  }
+
+  __attribute__((target("avx512f,avx512bw"))) void next() {
+    if constexpr (sizeof(Char) == 1)
+      ks = _mm512_add_epi8(ks, step);
+    else if constexpr (sizeof(Char) == 2)
+      ks = _mm512_add_epi16(ks, step);
+    else
+      ks = _mm512_add_epi32(ks, step);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+template <typename Char>
+__attribute__((target("sse2"))) inline void
+xor_keystream_sse2(Char *dst, const Char *src, std::size_t n, Char key,
+                   std::size_t pos) {
+  constexpr std::size_t lanes = sse2_keystream<Char>::lanes;
+  std::size_t i = 0;
+  if (n >= lanes) {
+    sse2_keystream<Char> ks(key, pos);
+    for (; i + lanes <= n; i += lanes, ks.next()) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                       _mm_xor_si128(v, ks.ks));
+    }
+  }
+  xor_keystream_scalar(dst + i, src + i, n - i, key, pos + i);
+}
+
+template <typename Char>
+__attribute__((target("avx2"))) inline void
+xor_keystream_avx2(Char *dst, const Char *src, std::size_t n, Char key,
+                   std::size_t pos) {
+  constexpr std::size_t lanes = avx2_keystream<Char>::lanes;
+  std::size_t i = 0;
+  if (n >= lanes) {
+    avx2_keystream<Char> ks(key, pos);
+    for (; i + lanes <= n; i += lanes, ks.next()) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                          _mm256_xor_si256(v, ks.ks));
+    }
+  }
+  xor_keystream_scalar(dst + i, src + i, n - i, key, pos + i);
+}
+
+template <typename Char>
+__attribute__((target("avx512f,avx512bw"))) inline void
+xor_keystream_avx512(Char *dst, const Char *src, std::size_t n, Char key,
+                     std::size_t pos) {
+  constexpr std::size_t lanes = avx512_keystream<Char>::lanes;
+  std::size_t i = 0;
+  if (n >= lanes) {
+    avx512_keystream<Char> ks(key, pos);
+    for (; i + lanes <= n; i += lanes, ks.next()) {
+      const __m512i v = _mm512_loadu_si512(src + i);
+      _mm512_storeu_si512(dst + i, _mm512_xor_si512(v, ks.ks));
+    }
+  }
+  xor_keystream_scalar(dst + i, src + i, n - i, key, pos + i);
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename Char>
+__attribute__((target("sse2"))) inline bool
+xor_keystream_equal_sse2(const Char *encrypted, const Char *probe,
+                         std::size_t n, Char key, std::size_t pos) {
+  constexpr std::size_t lanes = sse2_keystream<Char>::lanes;
+  std::size_t i = 0;
+  __m128i diff = _mm_setzero_si128();
+  if (n >= lanes) {
+    sse2_keystream<Char> ks(key, pos);
+    for (; i + lanes <= n; i += lanes, ks.next()) {
+      const __m128i e =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(encrypted + i));
+      const __m128i p =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(probe + i));
+      diff = _mm_or_si128(diff, _mm_xor_si128(_mm_xor_si128(e, ks.ks), p));
+    }
+  }
+  const bool equal =
+      _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xFFFF;
+  return equal & xor_keystream_equal_scalar(encrypted + i, probe + i, n - i,
+                                            key, pos + i);
+}
+
+template <typename Char>
+__attribute__((target("avx2"))) inline bool
+xor_keystream_equal_avx2(const Char *encrypted, const Char *probe,
+                         std::size_t n, Char key, std::size_t pos) {
+  constexpr std::size_t lanes = avx2_keystream<Char>::lanes;
+  std::size_t i = 0;
+  __m256i diff = _mm256_setzero_si256();
+  if (n >= lanes) {
+    avx2_keystream<Char> ks(key, pos);
+    for (; i + lanes <= n; i += lanes, ks.next()) {
+      const __m256i e = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(encrypted + i));
+      const __m256i p =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(probe + i));
+      diff = _mm256_or_si256(diff,
+                             _mm256_xor_si256(_mm256_xor_si256(e, ks.ks), p));
+    }
+  }
+  const bool equal = _mm256_testz_si256(diff, diff);
+  return equal & xor_keystream_equal_scalar(encrypted + i, probe + i, n - i,
+                                            key, pos + i);
+}
+
+template <typename Char>
+__attribute__((target("avx512f,avx512bw"))) inline bool
+xor_keystream_equal_avx512(const Char *encrypted, const Char *probe,
+                           std::size_t n, Char key, std::size_t pos) {
+  constexpr std::size_t lanes = avx512_keystream<Char>::lanes;
+  std::size_t i = 0;
+  __m512i diff = _mm512_setzero_si512();
+  if (n >= lanes) {
+    avx512_keystream<Char> ks(key, pos);
+    for (; i + lanes <= n; i += lanes, ks.next()) {
+      const __m512i e = _mm512_loadu_si512(encrypted + i);
+      const __m512i p = _mm512_loadu_si512(probe + i);
+      diff = _mm512_or_si512(diff,
+                             _mm512_xor_si512(_mm512_xor_si512(e, ks.ks), p));
+    }
+  }
+  const bool equal = _mm512_test_epi64_mask(diff, diff) == 0;
+  return equal & xor_keystream_equal_scalar(encrypted + i, probe + i, n - i,
+                                            key, pos + i);
+}
+
+#endif // TBX_XSTR_X86_KERNELS
+
+// -----------------------------------------------------------------------------
+
+#ifdef TBX_XSTR_X86_KERNELS
+
+template <typename Char>
+using xor_keystream_fn = void (*)(Char *, const Char *, std::size_t, Char,
+                                  std::size_t);
+
+// @return the widest kernel supported by the CPU we are running on
+template <typename Char> xor_keystream_fn<Char> select_xor_keystream() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512bw"))
+    return &xor_keystream_avx512<Char>;
+  if (__builtin_cpu_supports("avx2"))
+    return &xor_keystream_avx2<Char>;
+  if (__builtin_cpu_supports("sse2"))
+    return &xor_keystream_sse2<Char>;
+  return &xor_keystream_scalar<Char>;
+}
+
+template <typename Char>
+void xor_keystream_resolve(Char *dst, const Char *src, std::size_t n, Char key,
+                           std::size_t pos);
+
+// Kernel used by xor_keystream(). It is constant-initialized to the resolver
+// so it is valid even during static initialization; the first call replaces
+// it with the selected kernel and every later call jumps there directly.
+template <typename Char>
+inline std::atomic<xor_keystream_fn<Char>> xor_keystream_impl{
+    &xor_keystream_resolve<Char>};
+
+template <typename Char>
+void xor_keystream_resolve(Char *dst, const Char *src, std::size_t n, Char key,
+                           std::size_t pos) {
+  // Racing threads all compute the same pointer, so a relaxed store is enough.
+  const xor_keystream_fn<Char> kernel = select_xor_keystream<Char>();
+  xor_keystream_impl<Char>.store(kernel, std::memory_order_relaxed);
+  kernel(dst, src, n, key, pos);
+}
+
+template <typename Char>
+using xor_keystream_equal_fn = bool (*)(const Char *, const Char *, std::size_t,
+                                        Char, std::size_t);
+
+// @return the widest comparison kernel supported by the running CPU
+template <typename Char>
+xor_keystream_equal_fn<Char> select_xor_keystream_equal() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512bw"))
+    return &xor_keystream_equal_avx512<Char>;
+  if (__builtin_cpu_supports("avx2"))
+    return &xor_keystream_equal_avx2<Char>;
+  if (__builtin_cpu_supports("sse2"))
+    return &xor_keystream_equal_sse2<Char>;
+  return &xor_keystream_equal_scalar<Char>;
+}
+
+template <typename Char>
+bool xor_keystream_equal_resolve(const Char *encrypted, const Char *probe,
+                                 std::size_t n, Char key, std::size_t pos);
+
+// Same lazy resolution as xor_keystream_impl.
+template <typename Char>
+inline std::atomic<xor_keystream_equal_fn<Char>> xor_keystream_equal_impl{
+    &xor_keystream_equal_resolve<Char>};
+
+template <typename Char>
+bool xor_keystream_equal_resolve(const Char *encrypted, const Char *probe,
+                                 std::size_t n, Char key, std::size_t pos) {
+  const xor_keystream_equal_fn<Char> kernel =
+      select_xor_keystream_equal<Char>();
+  xor_keystream_equal_impl<Char>.store(kernel, std::memory_order_relaxed);
+  return kernel(encrypted, probe, n, key, pos);
+}
+
+#endif // TBX_XSTR_X86_KERNELS
+
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Applies the obfuscation keystream with the widest kernel supported
+ *        by the running CPU.
+ *
+ * The kernel is picked with cpuid on first use and cached, so a single binary
+ * built without -mavx2 still uses AVX2/AVX-512 where available. When the
+ * translation unit is already compiled for AVX-512BW the kernel is called
+ * directly. Strings shorter than one SSE register never leave the inline
+ * scalar loop.
+ *
+ * @see xor_keystream_scalar
+ */
+template <typename Char>
+inline void xor_keystream(Char *dst, const Char *src, std::size_t n, Char key,
+                          std::size_t pos = 0) {
+#ifdef TBX_XSTR_X86_KERNELS
+  if constexpr (has_simd_lanes<Char>) {
+    if (n * sizeof(Char) >= 16) {
+#if defined(__AVX512BW__)
+      xor_keystream_avx512(dst, src, n, key, pos);
+#else
+      xor_keystream_impl<Char>.load(std::memory_order_relaxed)(dst, src, n,
+                                                               key, pos);
+#endif
+      return;
+    }
+  }
+#endif
+  xor_keystream_scalar(dst, src, n, key, pos);
+}
+
+/**
+ * @brief Compares a probe with an encrypted range in the encrypted domain,
+ *        with the widest kernel supported by the running CPU.
+ *
+ * @see xor_keystream_equal_scalar
+ */
+template <typename Char>
+inline bool xor_keystream_equal(const Char *encrypted, const Char *probe,
+                                std::size_t n, Char key, std::size_t pos = 0) {
+#ifdef TBX_XSTR_X86_KERNELS
+  if constexpr (has_simd_lanes<Char>) {
+    if (n * sizeof(Char) >= 16) {
+#if defined(__AVX512BW__)
+      return xor_keystream_equal_avx512(encrypted, probe, n, key, pos);
+#else
+      return xor_keystream_equal_impl<Char>.load(std::memory_order_relaxed)(
+          encrypted, probe, n, key, pos);
+#endif
+    }
+  }
+#endif
+  return xor_keystream_equal_scalar(encrypted, probe, n, key, pos);
+}
+
+// -----------------------------------------------------------------------------
+// Counter-mode keystream
+//
+// Byte p of this keystream is byte (p % 4) of mix32(seed ^ (p / 4)), i.e. the
+// keystream is the little-endian concatenation of one 32-bit hash per 4-byte
+// word. mix32 is the murmur3 finalizer: a bijection with full avalanche, so
+// unlike the ramp the key cannot be read off two adjacent characters. It is
+// only shifts, xors and 32-bit multiplies, which every vector ISA has, and a
+// register of N words is N independent hashes: no carried state.
+
+constexpr std::uint32_t mix32(std::uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x85EBCA6Bu;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35u;
+  x ^= x >> 16;
+  return x;
+}
+
+// @return byte @p p of the counter-mode keystream
+constexpr std::uint8_t counter_keystream_byte(std::uint32_t seed,
+                                              std::size_t p) {
+  return static_cast<std::uint8_t>(
+      mix32(seed ^ static_cast<std::uint32_t>(p >> 2)) >> (8 * (p & 3)));
+}
+
+// @return the keystream of the character at index @p i, i.e. the bytes
+//         [i * sizeof(Char), (i + 1) * sizeof(Char)) in little-endian order
+template <typename Char>
+constexpr Char counter_keystream_char(std::uint32_t seed, std::size_t i) {
+  using Unsigned = std::make_unsigned_t<Char>;
+  Unsigned value = 0;
+  for (std::size_t b = 0; b < sizeof(Char); ++b)
+    value |= static_cast<Unsigned>(
+        static_cast<Unsigned>(counter_keystream_byte(seed, i * sizeof(Char) + b))
+        << (8 * b));
+  return static_cast<Char>(value);
+}
+
+/**
+ * @brief Compile-time counterpart of counter_keystream_scalar(), computing
+ *        one mix32 per 4-byte keystream word rather than one per byte.
+ *
+ * @param pos Absolute index of src[0], a multiple of 4 / sizeof(Char).
+ */
+template <typename Char>
+constexpr void counter_keystream_encrypt(Char *dst, const Char *src,
+                                         std::size_t n, std::uint32_t seed,
+                                         std::size_t pos) {
+  if constexpr (4 % sizeof(Char) != 0) {
+    for (std::size_t i = 0; i < n; ++i)
+      dst[i] = static_cast<Char>(src[i] ^
+                                 counter_keystream_char<Char>(seed, pos + i));
+  } else {
+    constexpr std::size_t per_word = 4 / sizeof(Char);
+    for (std::size_t i = 0; i < n;) {
+      const std::uint32_t k =
+          mix32(seed ^ static_cast<std::uint32_t>((pos + i) / per_word));
+      for (std::size_t j = 0; j < per_word && i < n; ++j, ++i)
+        dst[i] = static_cast<Char>(
+            src[i] ^ static_cast<Char>(k >> (8 * sizeof(Char) * j)));
+    }
+  }
+}
+
+/**
+ * @brief Applies the counter-mode keystream to a range of characters.
+ *
+ * @param seed Keystream seed, usually XORSEED.
+ * @param pos  Absolute index of src[0] inside the obfuscated string.
+ *
+ * @see xor_keystream_scalar
+ */
+template <typename Char>
+inline void counter_keystream_scalar(Char *dst, const Char *src, std::size_t n,
+                                     std::uint32_t seed, std::size_t pos) {
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = static_cast<Char>(src[i] ^
+                               counter_keystream_char<Char>(seed, pos + i));
+}
+
+#ifdef TBX_XSTR_X86_KERNELS
+
+// The vector kernels work on bytes: @p p is the byte position of src[0] and
+// must be a multiple of 4, @p n is rounded down to a multiple of 16 and the
+// number of bytes processed is returned. Wider kernels finish the range with
+// the narrower ones.
+
+// Once inlined into a caller with a short array, GCC 12 flags the loads of
+// the unreachable wide loops with -Warray-bounds. Ranges shorter than one
+// register also skip to the narrower kernel up front.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+
+__attribute__((target("sse4.1"))) inline std::size_t
+counter_keystream_sse41(std::uint8_t *dst, const std::uint8_t *src,
+                        std::size_t n, std::uint32_t seed, std::size_t p) {
+  const __m128i four = _mm_set1_epi32(4);
+  const __m128i m1 = _mm_set1_epi32(static_cast<int>(0x85EBCA6Bu));
+  const __m128i m2 = _mm_set1_epi32(static_cast<int>(0xC2B2AE35u));
+  const __m128i s = _mm_set1_epi32(static_cast<int>(seed));
+  __m128i ctr = _mm_add_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+          ramp<std::uint32_t>.data())),
+      _mm_set1_epi32(static_cast<int>(p >> 2)));
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16, ctr = _mm_add_epi32(ctr, four)) {
+    __m128i x = _mm_xor_si128(ctr, s);
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = _mm_mullo_epi32(x, m1);
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 13));
+    x = _mm_mullo_epi32(x, m2);
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(v, x));
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) inline std::size_t
+counter_keystream_avx2(std::uint8_t *dst, const std::uint8_t *src,
+                       std::size_t n, std::uint32_t seed, std::size_t p) {
+  if (n < 32)
+    return counter_keystream_sse41(dst, src, n, seed, p);
+  const __m256i eight = _mm256_set1_epi32(8);
+  const __m256i m1 = _mm256_set1_epi32(static_cast<int>(0x85EBCA6Bu));
+  const __m256i m2 = _mm256_set1_epi32(static_cast<int>(0xC2B2AE35u));
+  const __m256i s = _mm256_set1_epi32(static_cast<int>(seed));
+  __m256i ctr = _mm256_add_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(
+          ramp<std::uint32_t>.data())),
+      _mm256_set1_epi32(static_cast<int>(p >> 2)));
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32, ctr = _mm256_add_epi32(ctr, eight)) {
+    __m256i x = _mm256_xor_si256(ctr, s);
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, m1);
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 13));
+    x = _mm256_mullo_epi32(x, m2);
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_xor_si256(v, x));
+  }
+  return i + counter_keystream_sse41(dst + i, src + i, n - i, seed, p + i);
+}
+
+__attribute__((target("avx512f"))) inline std::size_t
+counter_keystream_avx512(std::uint8_t *dst, const std::uint8_t *src,
+                         std::size_t n, std::uint32_t seed, std::size_t p) {
+  if (n < 64)
+    return counter_keystream_avx2(dst, src, n, seed, p);
+  const __m512i sixteen = _mm512_set1_epi32(16);
+  const __m512i m1 = _mm512_set1_epi32(static_cast<int>(0x85EBCA6Bu));
+  const __m512i m2 = _mm512_set1_epi32(static_cast<int>(0xC2B2AE35u));
+  const __m512i s = _mm512_set1_epi32(static_cast<int>(seed));
+  __m512i ctr = _mm512_add_epi32(_mm512_loadu_si512(ramp<std::uint32_t>.data()),
+                                 _mm512_set1_epi32(static_cast<int>(p >> 2)));
+  // The maskz form of the shifts is the same instruction; the unmasked one
+  // trips -Wmaybe-uninitialized inside the GCC 12 headers.
+  constexpr __mmask16 all = 0xFFFF;
+  std::size_t i = 0;
+  for (; i + 64 <= n; i += 64, ctr = _mm512_add_epi32(ctr, sixteen)) {
+    __m512i x = _mm512_xor_si512(ctr, s);
+    x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(all, x, 16));
+    x = _mm512_mullo_epi32(x, m1);
+    x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(all, x, 13));
+    x = _mm512_mullo_epi32(x, m2);
+    x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(all, x, 16));
+    _mm512_storeu_si512(dst + i,
+                        _mm512_xor_si512(_mm512_loadu_si512(src + i), x));
+  }
+  return i + counter_keystream_avx2(dst + i, src + i, n - i, seed, p + i);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+using counter_keystream_fn = std::size_t (*)(std::uint8_t *,
+                                             const std::uint8_t *, std::size_t,
+                                             std::uint32_t, std::size_t);
+
+inline std::size_t counter_keystream_none(std::uint8_t *, const std::uint8_t *,
+                                          std::size_t, std::uint32_t,
+                                          std::size_t) {
+  return 0;
+}
+
+// @return the widest counter-mode kernel supported by the running CPU
+inline counter_keystream_fn select_counter_keystream() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return &counter_keystream_avx512;
+  if (__builtin_cpu_supports("avx2"))
+    return &counter_keystream_avx2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return &counter_keystream_sse41;
+  return &counter_keystream_none;
+}
+
+inline std::size_t counter_keystream_resolve(std::uint8_t *dst,
+                                             const std::uint8_t *src,
+                                             std::size_t n, std::uint32_t seed,
+                                             std::size_t p);
+
+// Same lazy resolution as xor_keystream_impl.
+inline std::atomic<counter_keystream_fn> counter_keystream_impl{
+    &counter_keystream_resolve};
+
+inline std::size_t counter_keystream_resolve(std::uint8_t *dst,
+                                             const std::uint8_t *src,
+                                             std::size_t n, std::uint32_t seed,
+                                             std::size_t p) {
+  const counter_keystream_fn kernel = select_counter_keystream();
+  counter_keystream_impl.store(kernel, std::memory_order_relaxed);
+  return kernel(dst, src, n, seed, p);
+}
+
+#endif // TBX_XSTR_X86_KERNELS
+
+/**
+ * @brief Applies the counter-mode keystream with the widest kernel supported
+ *        by the running CPU.
+ *
+ * The vector kernels operate on the byte image of the characters, which
+ * matches counter_keystream_char() on little-endian targets such as x86. The
+ * characters before the first 4-byte keystream word boundary and the tail
+ * go through the scalar loop.
+ *
+ * @see counter_keystream_scalar
+ */
+template <typename Char>
+inline void counter_keystream(Char *dst, const Char *src, std::size_t n,
+                              std::uint32_t seed, std::size_t pos = 0) {
+#ifdef TBX_XSTR_X86_KERNELS
+  if constexpr (has_simd_lanes<Char>) {
+    if (n * sizeof(Char) >= 16) {
+      std::size_t head = 0;
+      while ((pos + head) * sizeof(Char) % 4 != 0)
+        ++head;
+      counter_keystream_scalar(dst, src, head, seed, pos);
+      const std::size_t done =
+#if defined(__AVX512F__)
+          counter_keystream_avx512(
+#else
+          counter_keystream_impl.load(std::memory_order_relaxed)(
+#endif
+              reinterpret_cast<std::uint8_t *>(dst + head),
+              reinterpret_cast<const std::uint8_t *>(src + head),
+              (n - head) * sizeof(Char), seed, (pos + head) * sizeof(Char)) /
+          sizeof(Char);
+      const std::size_t i = head + done;
+      counter_keystream_scalar(dst + i, src + i, n - i, seed, pos + i);
+      return;
+    }
+  }
+#endif
+  counter_keystream_scalar(dst, src, n, seed, pos);
+}
+
+/**
+ * @brief Compares a probe with a range encrypted with the counter-mode
+ *        keystream, in the encrypted domain.
+ *
+ * The probe is encrypted with the vector kernels into a small stack buffer,
+ * one chunk at a time, and compared with @p encrypted, so the plaintext is
+ * never written to memory. All @p n characters are always examined.
+ *
+ * @see xor_keystream_equal_scalar
+ */
+template <typename Char>
+inline bool counter_keystream_equal(const Char *encrypted, const Char *probe,
+                                    std::size_t n, std::uint32_t seed,
+                                    std::size_t pos = 0) {
+  using Unsigned = std::make_unsigned_t<Char>;
+  constexpr std::size_t chunk = 256 / sizeof(Char);
+  Char ks[chunk];
+  Unsigned diff = 0;
+  for (std::size_t i = 0; i < n; i += chunk) {
+    const std::size_t len = n - i < chunk ? n - i : chunk;
+    counter_keystream(ks, probe + i, len, seed, pos + i);
+    for (std::size_t j = 0; j < len; ++j)
+      diff |= static_cast<Unsigned>(ks[j] ^ encrypted[i + j]);
+  }
+  return diff == 0;
+}
+
+// -----------------------------------------------------------------------------
+
+#if defined(_MSC_VER)
+#define TBX_XSTR_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__)
+#define TBX_XSTR_NOINLINE __attribute__((noinline))
+#else
+#define TBX_XSTR_NOINLINE
+#endif
+
+/**
+ * @brief Decrypts n characters of src into dst with the keystream policy
+ *        @p Keystream and null-terminates dst.
+ *
+ * This is the one decryption routine shared by every Xor_string<size, Char,
+ * Keystream> with the same Char and Keystream. It is kept out of line so that
+ * the thousands of literal sites of a program only emit a call, instead of
+ * one copy of the kernel per literal length.
+ */
+template <class Keystream, typename Char>
+TBX_XSTR_NOINLINE void xor_decrypt(Char *dst, const Char *src, std::size_t n) {
+  Keystream::apply(dst, src, n, 0);
+  dst[n] = Char();
+}
+
+} // namespace detail
+} // namespace crypt
@@ -0,0 +1,279 @@
+/**
+ * @file   xor_lazy_mapping.hpp
+ * @brief  This file provides lazy, page-granular decryption of an obfuscated
+ *         resource pack entry through Linux userfaultfd.
+ *
+ *         crypt::Xor_lazy_mapping reserves an anonymous region the size of a
+ *         crypt::Xor_pack_entry and registers it with userfaultfd. Nothing is
+ *         decrypted up front: the first access to a page faults, a handler
+ *         thread decrypts that page (plus an optional readahead window of the
+ *         following pages) straight from the pack mapping and installs it
+ *         with UFFDIO_COPY. Pages that are never touched are never decrypted
+ *         and cost no memory, which matters for packs of hundreds of MB.
+ *
+ *@note Linux only. Without CAP_SYS_PTRACE, the vm.unprivileged_userfaultfd
+ *      sysctl must allow it or the kernel must support UFFD_USER_MODE_ONLY
+ *      (5.11+), which this mapping requests.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/xor_pack.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <linux/userfaultfd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace crypt {
+// =============================================================================
+
+/**
+ * @brief Read-only view of a pack entry whose pages are decrypted on first
+ *        access.
+ *
+ * @code
+ * crypt::Xor_lazy_mapping weights;
+ * if (!weights.open(*pack.find("model.bin"), 8)) // 8 pages of readahead
+ *   return false; // errno tells why
+ * run_model(weights.data(), weights.size());
+ * auto s = weights.stats(); // faults, pages decrypted, latencies
+ * @endcode
+ */
+class Xor_lazy_mapping {
+public:
+  struct Stats {
+    // Page faults served.
+    std::uint64_t faults;
+    // Pages decrypted, readahead included.
+    std::uint64_t pages;
+    // Time spent decrypting, in nanoseconds.
+    std::uint64_t decrypt_ns;
+    // Time from reading a fault to waking the faulting thread, in
+    // nanoseconds: total and worst case.
+    std::uint64_t fault_ns;
+    std::uint64_t max_fault_ns;
+  };
+
+  Xor_lazy_mapping() = default;
+  Xor_lazy_mapping(const Xor_lazy_mapping &) = delete;
+  Xor_lazy_mapping &operator=(const Xor_lazy_mapping &) = delete;
+  ~Xor_lazy_mapping() { close(); }
+
+  /**
+   * @brief Reserves the region for @p entry and starts the fault handler.
+   *
+   * @param entry     The entry to expose; its Xor_pack must outlive the
+   *                  mapping.
+   * @param readahead Number of pages following a faulting page that are
+   *                  decrypted along with it.
+   * @return false on failure, with errno set accordingly
+   */
+  bool open(const Xor_pack_entry &entry, std::size_t readahead = 0) {
+    close();
+    for (auto *counter : {&_faults, &_decrypted, &_decrypt_ns, &_fault_ns,
+                          &_max_fault_ns})
+      counter->store(0, std::memory_order_relaxed);
+    _entry = entry;
+    _page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    _pages = (entry.size() + _page - 1) / _page;
+    _readahead = readahead;
+    if (!_pages)
+      return true;
+    // Non-blocking: poll() may report the descriptor readable with no
+    // message left to read.
+    constexpr int flags = O_CLOEXEC | O_NONBLOCK;
+    _uffd = static_cast<int>(
+        ::syscall(SYS_userfaultfd, flags | UFFD_USER_MODE_ONLY));
+    if (_uffd < 0 && errno == EINVAL)
+      _uffd = static_cast<int>(::syscall(SYS_userfaultfd, flags));
+    if (_uffd < 0)
+      return fail();
+    uffdio_api api{};
+    api.api = UFFD_API;
+    if (::ioctl(_uffd, UFFDIO_API, &api) != 0)
+      return fail();
+    void *region = ::mmap(nullptr, _pages * _page, PROT_READ,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+      return fail();
+    _region = static_cast<std::byte *>(region);
+    uffdio_register reg{};
+    reg.range.start = reinterpret_cast<std::uintptr_t>(_region);
+    reg.range.len = _pages * _page;
+    reg.mode = UFFDIO_REGISTER_MODE_MISSING;
+    if (::ioctl(_uffd, UFFDIO_REGISTER, &reg) != 0)
+      return fail();
+    _stop = ::eventfd(0, EFD_CLOEXEC);
+    if (_stop < 0)
+      return fail();
+    _populated.assign(_pages, false);
+    _handler = std::thread([this] { serve(); });
+    return true;
+  }
+
+  void close() {
+    if (_handler.joinable()) {
+      const std::uint64_t one = 1;
+      (void)!::write(_stop, &one, sizeof(one));
+      _handler.join();
+    }
+    if (_region)
+      ::munmap(_region, _pages * _page);
+    if (_uffd >= 0)
+      ::close(_uffd);
+    if (_stop >= 0)
+      ::close(_stop);
+    _region = nullptr;
+    _uffd = -1;
+    _stop = -1;
+    _pages = 0;
+    _populated.clear();
+  }
+
+  // @return the decrypted entry; pages are decrypted as they are touched
+  const std::byte *data() const { return _region; }
+  std::size_t size() const { return _entry.size(); }
+
+  Stats stats() const {
+    return {_faults.load(std::memory_order_relaxed),
+            _decrypted.load(std::memory_order_relaxed),
+            _decrypt_ns.load(std::memory_order_relaxed),
+            _fault_ns.load(std::memory_order_relaxed),
+            _max_fault_ns.load(std::memory_order_relaxed)};
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  static std::uint64_t elapsed_ns(clock::time_point since) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() -
+                                                             since)
+            .count());
+  }
+
+  bool fail() {
+    const int error = errno;
+    close();
+    errno = error;
+    return false;
+  }
+
+  void serve() {
+    std::vector<std::byte> scratch((_readahead + 1) * _page);
+    pollfd fds[2] = {{_uffd, POLLIN, 0}, {_stop, POLLIN, 0}};
+    for (;;) {
+      if (::poll(fds, 2, -1) < 0) {
+        if (errno == EINTR)
+          continue;
+        return;
+      }
+      if (fds[1].revents)
+        return;
+      uffd_msg msg;
+      if (::read(_uffd, &msg, sizeof(msg)) != sizeof(msg))
+        continue;
+      if (msg.event != UFFD_EVENT_PAGEFAULT)
+        continue;
+      const clock::time_point start = clock::now();
+      _faults.fetch_add(1, std::memory_order_relaxed);
+      const std::size_t first =
+          (static_cast<std::uintptr_t>(msg.arg.pagefault.address) -
+           reinterpret_cast<std::uintptr_t>(_region)) /
+          _page;
+      populate(first, scratch);
+      const std::uint64_t ns = elapsed_ns(start);
+      _fault_ns.fetch_add(ns, std::memory_order_relaxed);
+      if (ns > _max_fault_ns.load(std::memory_order_relaxed))
+        _max_fault_ns.store(ns, std::memory_order_relaxed);
+    }
+  }
+
+  // Decrypts the run of missing pages starting at `first`, at most
+  // readahead + 1 of them, and installs it with one UFFDIO_COPY.
+  void populate(std::size_t first, std::vector<std::byte> &scratch) {
+    std::size_t last = first;
+    while (last < _pages && last - first <= _readahead && !_populated[last])
+      ++last;
+    if (last == first) {
+      // Already installed by a previous readahead: just wake the thread.
+      wake(first);
+      return;
+    }
+    const clock::time_point start = clock::now();
+    const std::size_t begin = first * _page;
+    const std::size_t end = std::min(last * _page, _entry.size());
+    _entry.decrypt_range(begin, end - begin, scratch.data());
+    std::fill(scratch.data() + (end - begin),
+              scratch.data() + (last - first) * _page, std::byte{});
+    _decrypt_ns.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    _decrypted.fetch_add(last - first, std::memory_order_relaxed);
+
+    // The kernel wakes the faulting thread when it installs its page. A copy
+    // may stop early: only the pages it reports are marked, the rest is
+    // retried, and pages that already exist are skipped.
+    const std::size_t len = (last - first) * _page;
+    std::size_t done = 0;
+    bool woken = false;
+    while (done < len) {
+      uffdio_copy copy{};
+      copy.dst = reinterpret_cast<std::uintptr_t>(_region) + begin + done;
+      copy.src = reinterpret_cast<std::uintptr_t>(scratch.data() + done);
+      copy.len = len - done;
+      const bool ok = ::ioctl(_uffd, UFFDIO_COPY, &copy) == 0;
+      const int error = errno;
+      const std::size_t copied =
+          ok ? len - done
+             : copy.copy > 0 ? static_cast<std::size_t>(copy.copy) : 0;
+      for (std::size_t i = done / _page; i < (done + copied) / _page; ++i)
+        _populated[first + i] = true;
+      woken |= done == 0 && copied;
+      done += copied;
+      if (ok || copied)
+        continue;
+      if (error != EEXIST)
+        break; // e.g. EAGAIN while the mapping changes: let it fault again
+      _populated[first + done / _page] = true;
+      done += _page;
+    }
+    if (done < len || !woken)
+      wake(first);
+  }
+
+  void wake(std::size_t page) {
+    uffdio_range range{reinterpret_cast<std::uintptr_t>(_region) +
+                           page * _page,
+                       _page};
+    ::ioctl(_uffd, UFFDIO_WAKE, &range);
+  }
+
+  Xor_pack_entry _entry{nullptr, 0};
+  std::byte *_region = nullptr;
+  std::size_t _page = 0;
+  std::size_t _pages = 0;
+  std::size_t _readahead = 0;
+  int _uffd = -1;
+  int _stop = -1;
+  std::vector<bool> _populated;
+  std::thread _handler;
+  std::atomic<std::uint64_t> _faults{0};
+  std::atomic<std::uint64_t> _decrypted{0};
+  std::atomic<std::uint64_t> _decrypt_ns{0};
+  std::atomic<std::uint64_t> _fault_ns{0};
+  std::atomic<std::uint64_t> _max_fault_ns{0};
+};
+
+} // namespace crypt
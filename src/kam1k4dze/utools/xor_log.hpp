@@ -0,0 +1,182 @@
+/**
+ * @file   xor_log.hpp
+ * @brief  This file provides logging with obfuscated format strings that are
+ *         only decrypted when the message is actually written.
+ *
+ *         The XorLog macros hand the encrypted crypt::Xor_string of the
+ *         format string to the log path instead of a decrypted pointer. The
+ *         level is checked first: a disabled statement costs one load and
+ *         one branch, and never touches the encrypted string. An enabled one
+ *         decrypts the format into a thread-local scratch buffer, formats the
+ *         message with snprintf into a second one and passes it to the sink.
+ *
+ *         Format strings and arguments are checked like printf at compile
+ *         time, without the plaintext format being emitted.
+ *@note define TBX_XSTR_LOG_MIN_LEVEL (a crypt::Xor_log_level) before
+ *      including this file to compile out the statements below that level
+ *@note define TBX_XSTR_LOG_SCRATCH before including this file to change the
+ *      size of the per-thread buffers, 1024 characters by default. Longer
+ *      messages are truncated.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/cstring_obfuscator.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+
+#ifndef TBX_XSTR_LOG_SCRATCH
+#define TBX_XSTR_LOG_SCRATCH 1024
+#endif
+
+#ifndef TBX_XSTR_LOG_MIN_LEVEL
+#define TBX_XSTR_LOG_MIN_LEVEL crypt::Xor_log_level::trace
+#endif
+
+
+namespace crypt {
+// =============================================================================
+
+enum class Xor_log_level : int { trace, debug, info, warning, error, off };
+
+/**
+ * @brief Receives every message that passes the level check.
+ *
+ * @param message The formatted message, null-terminated, without a trailing
+ *                newline. It lives in a thread-local buffer that is reused
+ *                by the next message of the thread.
+ */
+using Xor_log_sink = void (*)(Xor_log_level level, const char *message,
+                              std::size_t length);
+
+namespace detail {
+inline void xor_log_stderr(Xor_log_level, const char *message,
+                           std::size_t length) {
+  std::fwrite(message, 1, length, stderr);
+  std::fputc('\n', stderr);
+}
+
+inline std::atomic<Xor_log_level> xor_log_threshold{Xor_log_level::info};
+inline std::atomic<Xor_log_sink> xor_log_sink{&xor_log_stderr};
+
+// Trivial types: no TLS guard or constructor call on access.
+inline thread_local char xor_log_format[TBX_XSTR_LOG_SCRATCH];
+inline thread_local char xor_log_message[TBX_XSTR_LOG_SCRATCH];
+} // namespace detail
+
+// Messages below @p level are dropped; Xor_log_level::off drops all of them.
+inline void set_log_level(Xor_log_level level) {
+  detail::xor_log_threshold.store(level, std::memory_order_relaxed);
+}
+
+// Replaces the sink, stderr by default. nullptr restores the default.
+inline void set_log_sink(Xor_log_sink sink) {
+  detail::xor_log_sink.store(sink ? sink : &detail::xor_log_stderr,
+                             std::memory_order_release);
+}
+
+// @return true if a message at @p level would be written
+inline bool log_enabled(Xor_log_level level) {
+  return level >= TBX_XSTR_LOG_MIN_LEVEL &&
+         level >= detail::xor_log_threshold.load(std::memory_order_relaxed);
+}
+
+namespace detail {
+/**
+ * Writes one message. Out of line so that the call site only holds the level
+ * check and the call.
+ *
+ * The format always goes through snprintf, arguments or not, so "%%" is
+ * written as "%" like printf does.
+ */
+template <unsigned size, class Keystream, typename... Args>
+TBX_XSTR_NOINLINE void
+xor_log_write(Xor_log_level level,
+              const Xor_string<size, char, Keystream> &format, Args... args) {
+  static_assert(size <= TBX_XSTR_LOG_SCRATCH,
+                "format string longer than TBX_XSTR_LOG_SCRATCH");
+  xor_decrypt<Keystream>(xor_log_format, format._string, size - 1);
+  // The format was checked against the arguments at the call site.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#endif
+  const int n = std::snprintf(xor_log_message, sizeof(xor_log_message),
+                              xor_log_format, args...);
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+  if (n < 0)
+    return;
+  std::size_t length = static_cast<std::size_t>(n);
+  if (length >= sizeof(xor_log_message))
+    length = sizeof(xor_log_message) - 1; // truncated
+  xor_log_sink.load(std::memory_order_acquire)(level, xor_log_message, length);
+}
+} // namespace detail
+
+} // namespace crypt
+
+
+// Splits the arguments of XorLog into the format string and the rest, so
+// format-only statements need no empty variadic argument (-Wpedantic in
+// C++17). TBX_XSTR_LOG_EXPAND works around the MSVC traditional preprocessor.
+#define TBX_XSTR_LOG_EXPAND(x) x
+#define TBX_XSTR_LOG_CAT(a, b) TBX_XSTR_LOG_CAT_(a, b)
+#define TBX_XSTR_LOG_CAT_(a, b) a##b
+#define TBX_XSTR_LOG_FIRST(format, ...) format
+#define TBX_XSTR_LOG_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12,  \
+                          _13, _14, _15, _16, _17, _18, _19, _20, _21, _22,    \
+                          _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, n, \
+                          ...)                                                 \
+  n
+// 1 if there are arguments after the format, 0 otherwise.
+#define TBX_XSTR_LOG_HAS_ARGS(...)                                             \
+  TBX_XSTR_LOG_EXPAND(TBX_XSTR_LOG_PICK(                                       \
+      __VA_ARGS__, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, \
+      1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, ~))
+#define TBX_XSTR_LOG_REST_0(format)
+#define TBX_XSTR_LOG_REST_1(format, ...) , __VA_ARGS__
+// The arguments after the format, with a leading comma, or nothing.
+#define TBX_XSTR_LOG_REST(...)                                                 \
+  TBX_XSTR_LOG_EXPAND(TBX_XSTR_LOG_CAT(TBX_XSTR_LOG_REST_,                     \
+                                       TBX_XSTR_LOG_HAS_ARGS(__VA_ARGS__))(    \
+      __VA_ARGS__))
+
+/**
+ * @brief Logs a printf-style message whose format string is obfuscated.
+ *
+ * @param level  One of trace, debug, info, warning, error.
+ * @param ...    The format string, which must be a string literal, followed
+ *               by at most 31 arguments.
+ *
+ * @code
+ * crypt::set_log_level(crypt::Xor_log_level::debug);
+ * XorLog(debug, "connecting to %s:%d", host, port);
+ * XorLogError("handshake failed");
+ * @endcode
+ *
+ * @note The arguments are only evaluated when the message is written.
+ */
+#define XorLog(level, ...)                                                     \
+  do {                                                                         \
+    (void)sizeof(std::printf(__VA_ARGS__));                                    \
+    if (crypt::log_enabled(crypt::Xor_log_level::level))                       \
+      crypt::detail::xor_log_write(                                            \
+          crypt::Xor_log_level::level,                                         \
+          []() -> const auto & {                                               \
+            static constexpr crypt::Xor_string<                                \
+                sizeof(TBX_XSTR_LOG_FIRST(__VA_ARGS__, ~)), char>              \
+                expr(TBX_XSTR_LOG_FIRST(__VA_ARGS__, ~));                      \
+            return expr;                                                       \
+          }() TBX_XSTR_LOG_REST(__VA_ARGS__));                                 \
+  } while (0)
+
+#define XorLogTrace(...) XorLog(trace, __VA_ARGS__)
+#define XorLogDebug(...) XorLog(debug, __VA_ARGS__)
+#define XorLogInfo(...) XorLog(info, __VA_ARGS__)
+#define XorLogWarning(...) XorLog(warning, __VA_ARGS__)
+#define XorLogError(...) XorLog(error, __VA_ARGS__)
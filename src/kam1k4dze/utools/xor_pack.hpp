@@ -0,0 +1,280 @@
+/**
+ * @file   xor_pack.hpp
+ * @brief  This file provides a runtime reader for obfuscated resource packs
+ *         produced at build time by the xorpack tool (tools/xorpack.cpp).
+ *
+ *         Encrypting large resources through the constexpr constructors of
+ *         crypt::Xor_blob is slow to compile and inflates object files. A
+ *         resource pack is encrypted once at build time with the same
+ *         keystream instead, and crypt::Xor_pack maps it into memory with
+ *         mmap. Entries are never copied out of the mapping as a whole: they
+ *         are decrypted straight from the mapped pages into caller buffers,
+ *         page by page, so startup does not read the whole file.
+ *
+ *         Pack layout (native endianness):
+ *         - Xor_pack_header
+ *         - one Xor_pack_record per entry
+ *         - entry names, each encrypted from keystream position 0
+ *         - entry data, each aligned on xor_pack_alignment and encrypted
+ *           from keystream position 0
+ *
+ *@note POSIX only.
+ *@note the pack must be written with the same TBX_XSTR_SEED as the reader.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/xor_blob.hpp>
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace crypt {
+// =============================================================================
+
+constexpr char xor_pack_magic[4] = {'X', 'P', 'A', 'K'};
+constexpr std::uint32_t xor_pack_version = 1;
+// Alignment of entry data inside the pack, one page on every common target.
+constexpr std::uint32_t xor_pack_alignment = 4096;
+
+struct Xor_pack_header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t count;
+  std::uint32_t alignment;
+};
+
+struct Xor_pack_record {
+  std::uint64_t name_offset;
+  std::uint64_t name_size;
+  std::uint64_t data_offset;
+  std::uint64_t data_size;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief One encrypted resource inside a mapped pack.
+ *
+ * The entry refers to the mapping of its Xor_pack and must not outlive it.
+ */
+class Xor_pack_entry {
+public:
+  constexpr Xor_pack_entry(const std::byte *data, std::size_t size)
+      : _data(data), _size(size) {}
+
+  constexpr std::size_t size() const { return _size; }
+
+  // @return the number of xor_pack_alignment-sized pages of the entry
+  constexpr std::size_t page_count() const {
+    return (_size + xor_pack_alignment - 1) / xor_pack_alignment;
+  }
+
+  // @return a stream decrypting the entry from the mapped pages
+  constexpr Xor_blob_stream stream() const { return {_data, _size}; }
+
+  /**
+   * @brief Decrypts page @p index of the entry into @p out.
+   *
+   * @param out Destination of xor_pack_alignment bytes.
+   * @return the number of bytes written, less than a page for the last one
+   */
+  std::size_t decrypt_page(std::size_t index, std::byte *out) const {
+    Xor_blob_stream s = stream();
+    s.seek(index * xor_pack_alignment);
+    return s.next_chunk(out, xor_pack_alignment);
+  }
+
+  /**
+   * @brief Decrypts @p n bytes starting at @p pos into @p out.
+   *
+   * @return the number of bytes written to @p out, clamped to the end of
+   *         the entry
+   *
+   * @see Xor_blob::decrypt_range
+   */
+  std::size_t decrypt_range(std::size_t pos, std::size_t n,
+                            std::byte *out) const {
+    Xor_blob_stream s = stream();
+    s.seek(pos);
+    return s.next_chunk(out, n);
+  }
+
+private:
+  const std::byte *_data;
+  std::size_t _size;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Read-only mapping of an obfuscated resource pack.
+ *
+ * @code
+ * crypt::Xor_pack pack;
+ * if (!pack.open("resources.xpak"))
+ *   return false; // errno tells why
+ * if (auto shader = pack.find("shaders/main.frag"))
+ *   for (auto s = shader->stream(); !s.done();)
+ *     upload(page, s.next_chunk(page, sizeof(page)));
+ * @endcode
+ */
+class Xor_pack {
+public:
+  Xor_pack() = default;
+  Xor_pack(const Xor_pack &) = delete;
+  Xor_pack &operator=(const Xor_pack &) = delete;
+
+  Xor_pack(Xor_pack &&other) noexcept
+      : _map(other._map), _size(other._size), _count(other._count) {
+    other._map = nullptr;
+    other._size = 0;
+    other._count = 0;
+  }
+
+  Xor_pack &operator=(Xor_pack &&other) noexcept {
+    if (this != &other) {
+      close();
+      std::swap(_map, other._map);
+      std::swap(_size, other._size);
+      std::swap(_count, other._count);
+    }
+    return *this;
+  }
+
+  ~Xor_pack() { close(); }
+
+  /**
+   * @brief Maps the pack at @p path and validates its index.
+   *
+   * @return false if the file cannot be mapped or is not a valid pack, with
+   *         errno set accordingly
+   */
+  bool open(const char *path) {
+    close();
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < 0) {
+      ::close(fd);
+      return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void *map = size ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                     : MAP_FAILED;
+    ::close(fd);
+    if (map == MAP_FAILED) {
+      if (!size)
+        errno = EINVAL;
+      return false;
+    }
+    _map = static_cast<const std::byte *>(map);
+    _size = size;
+    if (!validate()) {
+      close();
+      errno = EINVAL;
+      return false;
+    }
+    return true;
+  }
+
+  void close() {
+    if (_map)
+      ::munmap(const_cast<std::byte *>(_map), _size);
+    _map = nullptr;
+    _size = 0;
+    _count = 0;
+  }
+
+  bool is_open() const { return _map != nullptr; }
+
+  // @return the number of entries in the pack
+  std::size_t count() const { return _count; }
+
+  // @return the entry at @p index, in the order the pack was written
+  Xor_pack_entry entry(std::size_t index) const {
+    const Xor_pack_record r = record(index);
+    return {_map + r.data_offset, static_cast<std::size_t>(r.data_size)};
+  }
+
+  /**
+   * @brief Looks up an entry by name.
+   *
+   * Names are compared in the encrypted domain and never decrypted.
+   */
+  std::optional<Xor_pack_entry> find(std::string_view name) const {
+    for (std::size_t i = 0; i < _count; ++i) {
+      const Xor_pack_record r = record(i);
+      if (r.name_size == name.size() &&
+          detail::xor_keystream_equal<char>(
+              reinterpret_cast<const char *>(_map + r.name_offset),
+              name.data(), name.size(), static_cast<char>(XORKEY)))
+        return entry(i);
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Tells the kernel how entry @p index is about to be read.
+   *
+   * @param advice An madvise() advice such as MADV_SEQUENTIAL or
+   *               MADV_WILLNEED.
+   */
+  void advise(std::size_t index, int advice) const {
+    const Xor_pack_record r = record(index);
+    const std::size_t begin =
+        r.data_offset & ~std::size_t{xor_pack_alignment - 1};
+    ::madvise(const_cast<std::byte *>(_map + begin),
+              r.data_offset + r.data_size - begin, advice);
+  }
+
+private:
+  Xor_pack_record record(std::size_t index) const {
+    assert(index < _count);
+    Xor_pack_record r;
+    std::memcpy(&r,
+                _map + sizeof(Xor_pack_header) +
+                    index * sizeof(Xor_pack_record),
+                sizeof(r));
+    return r;
+  }
+
+  bool validate() {
+    Xor_pack_header header;
+    if (_size < sizeof(header))
+      return false;
+    std::memcpy(&header, _map, sizeof(header));
+    if (std::memcmp(header.magic, xor_pack_magic, sizeof(header.magic)) != 0 ||
+        header.version != xor_pack_version ||
+        header.alignment != xor_pack_alignment ||
+        header.count > (_size - sizeof(header)) / sizeof(Xor_pack_record))
+      return false;
+    _count = header.count;
+    for (std::size_t i = 0; i < _count; ++i) {
+      const Xor_pack_record r = record(i);
+      if (r.name_offset > _size || r.name_size > _size - r.name_offset ||
+          r.data_offset > _size || r.data_size > _size - r.data_offset)
+        return false;
+    }
+    return true;
+  }
+
+  const std::byte *_map = nullptr;
+  std::size_t _size = 0;
+  std::size_t _count = 0;
+};
+
+} // namespace crypt
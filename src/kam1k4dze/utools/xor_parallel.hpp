@@ -0,0 +1,167 @@
+/**
+ * @file   xor_parallel.hpp
+ * @brief  This file provides multi-threaded decryption of large obfuscated
+ *         payloads.
+ *
+ *         The keystream only depends on the position of a byte, so any range
+ *         of an encrypted payload can be decrypted independently. The
+ *         functions below split a payload into grains and hand them to an
+ *         executor: a caller-supplied one, the Xor_thread_executor thread
+ *         pool provided here, or a standard execution policy such as
+ *         std::execution::par_unseq when TBX_XSTR_EXECUTION is defined.
+ *
+ *         An executor is any callable invoked as executor(tasks, task) that
+ *         calls task(i) once for every i in [0, tasks), possibly
+ *         concurrently, and returns once all of them have completed.
+ *@note the execution policy overloads are only provided when
+ *      TBX_XSTR_EXECUTION is defined before including this file: with
+ *      libstdc++ merely including <execution> needs TBB (-ltbb) at link time.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/xor_blob.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(TBX_XSTR_EXECUTION) && __has_include(<execution>)
+#include <execution>
+#endif
+
+
+namespace crypt {
+// =============================================================================
+
+// Bytes decrypted by one task: large enough to amortize scheduling, small
+// enough to balance a multi-megabyte payload across many cores.
+constexpr std::size_t xor_parallel_grain = 256 * 1024;
+
+/**
+ * @brief Executor running tasks on a fixed number of threads, the calling
+ *        thread included.
+ *
+ * Threads are started per call and pull task indices from a shared counter,
+ * so uneven tasks still balance.
+ */
+class Xor_thread_executor {
+public:
+  explicit Xor_thread_executor(
+      unsigned threads = std::thread::hardware_concurrency())
+      : _threads(threads ? threads : 1) {}
+
+  template <class Task> void operator()(std::size_t tasks, Task &&task) const {
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+      for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) <
+                          tasks;)
+        task(i);
+    };
+    const std::size_t helpers =
+        std::min<std::size_t>(_threads, tasks ? tasks : 1) - 1;
+    std::vector<std::thread> pool;
+    pool.reserve(helpers);
+    for (std::size_t i = 0; i < helpers; ++i)
+      pool.emplace_back(worker);
+    worker();
+    for (auto &thread : pool)
+      thread.join();
+  }
+
+private:
+  unsigned _threads;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Decrypts @p n bytes of an encrypted payload in parallel.
+ *
+ * @param encrypted Encrypted bytes.
+ * @param out       Destination of @p n bytes; may be @p encrypted itself.
+ * @param n         Number of bytes.
+ * @param pos       Position of encrypted[0] inside the payload.
+ * @param executor  Executor the grains are submitted to.
+ * @param grain     Bytes per task.
+ */
+template <class Executor>
+void xor_decrypt_parallel(const std::byte *encrypted, std::byte *out,
+                          std::size_t n, std::size_t pos, Executor &&executor,
+                          std::size_t grain = xor_parallel_grain) {
+  const std::size_t tasks = (n + grain - 1) / grain;
+  executor(tasks, [=](std::size_t i) {
+    const std::size_t begin = i * grain;
+    const std::size_t len = std::min(grain, n - begin);
+    detail::xor_keystream<unsigned char>(
+        reinterpret_cast<unsigned char *>(out + begin),
+        reinterpret_cast<const unsigned char *>(encrypted + begin), len,
+        static_cast<unsigned char>(XORKEY), pos + begin);
+  });
+}
+
+#if defined(TBX_XSTR_EXECUTION) && defined(__cpp_lib_execution)
+/**
+ * @brief Decrypts @p n bytes of an encrypted payload with a standard
+ *        execution policy, e.g. std::execution::par_unseq. Needs
+ *        TBX_XSTR_EXECUTION.
+ *
+ * @see xor_decrypt_parallel(const std::byte *, std::byte *, std::size_t,
+ *      std::size_t, Executor &&, std::size_t)
+ */
+template <class Policy,
+          std::enable_if_t<
+              std::is_execution_policy_v<std::remove_cv_t<
+                  std::remove_reference_t<Policy>>>,
+              int> = 0>
+void xor_decrypt_parallel(Policy &&policy, const std::byte *encrypted,
+                          std::byte *out, std::size_t n, std::size_t pos = 0,
+                          std::size_t grain = xor_parallel_grain) {
+  xor_decrypt_parallel(
+      encrypted, out, n, pos,
+      [&policy](std::size_t tasks, auto &&task) {
+        std::vector<std::size_t> indices(tasks);
+        std::iota(indices.begin(), indices.end(), std::size_t{0});
+        std::for_each(policy, indices.begin(), indices.end(), task);
+      },
+      grain);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Decrypts a whole Xor_blob in parallel into @p out.
+ *
+ * @param blob     The encrypted payload.
+ * @param out      Destination of blob._nb_bytes bytes.
+ * @param executor An executor, or a standard execution policy when
+ *                 TBX_XSTR_EXECUTION is defined.
+ *
+ * @code
+ * std::vector<std::byte> weights(model._nb_bytes);
+ * crypt::decrypt_parallel(model, weights.data(), crypt::Xor_thread_executor{});
+ * @endcode
+ */
+template <std::size_t size, class Executor>
+void decrypt_parallel(const Xor_blob<size> &blob, std::byte *out,
+                      Executor &&executor) {
+#if defined(TBX_XSTR_EXECUTION) && defined(__cpp_lib_execution)
+  if constexpr (std::is_execution_policy_v<
+                    std::remove_cv_t<std::remove_reference_t<Executor>>>) {
+    xor_decrypt_parallel(std::forward<Executor>(executor), blob._data, out,
+                         size);
+    return;
+  } else
+#endif
+  {
+    xor_decrypt_parallel(blob._data, out, size, 0,
+                         std::forward<Executor>(executor));
+  }
+}
+
+} // namespace crypt
@@ -0,0 +1,278 @@
+/**
+ * @file   xor_sink.hpp
+ * @brief  This file provides sinks that decrypt obfuscated strings and
+ *         payloads straight into their destination.
+ *
+ *         Sending an obfuscated literal somewhere usually means decrypting it
+ *         into a temporary and copying that into the output. The adapters
+ *         below decrypt each piece exactly once, into the destination itself
+ *         when it is contiguous memory, otherwise into a small stack chunk
+ *         that is handed over as is:
+ *         - operator<< writes a crypt::Xor_string, crypt::Xor_blob or
+ *           crypt::Xor_blob_stream to a std::ostream through its streambuf;
+ *         - crypt::decrypt_copy() writes them to an output iterator;
+ *         - crypt::write_fd() gathers them, together with plain buffers,
+ *           into write(2)/writev(2) calls on a file descriptor (POSIX).
+ *
+ *         Payloads are read through Xor_blob_stream, so a pack entry of
+ *         xor_pack.hpp is written with its stream().
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/xor_blob.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+
+namespace crypt {
+// =============================================================================
+namespace detail {
+
+// Bytes decrypted per step when the destination is not contiguous memory.
+constexpr std::size_t xor_sink_chunk = 4096;
+
+// Xor_blob_stream-like reader over the characters of an Xor_string.
+template <unsigned size, typename Char, class Keystream>
+class xor_string_reader {
+public:
+  using value_type = Char;
+
+  explicit constexpr xor_string_reader(
+      const Xor_string<size, Char, Keystream> &string)
+      : _string(string) {}
+
+  constexpr bool done() const { return _pos == size - 1; }
+
+  std::size_t next_chunk(Char *out, std::size_t capacity) {
+    const unsigned len =
+        static_cast<unsigned>(std::min<std::size_t>(capacity, UINT_MAX));
+    const std::size_t n = _string.decrypt_range(_pos, len, out).size();
+    _pos += static_cast<unsigned>(n);
+    return n;
+  }
+
+private:
+  const Xor_string<size, Char, Keystream> &_string;
+  unsigned _pos = 0;
+};
+
+template <unsigned size, typename Char, class Keystream>
+constexpr xor_string_reader<size, Char, Keystream>
+xor_reader(const Xor_string<size, Char, Keystream> &string) {
+  return xor_string_reader<size, Char, Keystream>(string);
+}
+
+template <std::size_t size>
+constexpr Xor_blob_stream xor_reader(const Xor_blob<size> &blob) {
+  return blob.stream();
+}
+
+constexpr Xor_blob_stream xor_reader(Xor_blob_stream stream) {
+  return stream;
+}
+
+template <class Reader, typename Char, class Traits>
+std::basic_ostream<Char, Traits> &
+xor_insert(std::basic_ostream<Char, Traits> &os, Reader reader) {
+  using T = typename Reader::value_type;
+  static_assert(sizeof(T) == sizeof(Char), "character size mismatch");
+  const typename std::basic_ostream<Char, Traits>::sentry ok(os);
+  if (!ok)
+    return os;
+  T chunk[xor_sink_chunk / sizeof(T)];
+  while (const std::size_t n = reader.next_chunk(chunk, std::size(chunk))) {
+    const auto written = os.rdbuf()->sputn(
+        reinterpret_cast<const Char *>(chunk), static_cast<std::streamsize>(n));
+    if (written != static_cast<std::streamsize>(n)) {
+      os.setstate(std::ios_base::badbit);
+      break;
+    }
+  }
+  return os;
+}
+
+} // namespace detail
+
+/**
+ * @brief Writes the plaintext of @p string to @p os, unformatted like
+ *        std::basic_ostream::write().
+ *
+ * @code
+ * XorS(greeting, "Hello, World!");
+ * std::cout << greeting << '\n';
+ * @endcode
+ */
+template <unsigned size, typename Char, class Keystream, class Traits>
+std::basic_ostream<Char, Traits> &
+operator<<(std::basic_ostream<Char, Traits> &os,
+           const Xor_string<size, Char, Keystream> &string) {
+  return detail::xor_insert(os, detail::xor_reader(string));
+}
+
+// Writes the plaintext of @p blob to @p os, unformatted.
+template <std::size_t size>
+std::ostream &operator<<(std::ostream &os, const Xor_blob<size> &blob) {
+  return detail::xor_insert(os, blob.stream());
+}
+
+// Writes what remains of @p stream to @p os, unformatted.
+inline std::ostream &operator<<(std::ostream &os, Xor_blob_stream stream) {
+  return detail::xor_insert(os, stream);
+}
+
+/**
+ * @brief Decrypts @p source into the output iterator @p out.
+ *
+ * A pointer to the character type of the source is written to directly;
+ * other iterators receive the plaintext in chunks from a stack buffer.
+ *
+ * @param source An Xor_string, Xor_blob or Xor_blob_stream.
+ * @return the iterator past the last character written
+ *
+ * @code
+ * std::string request;
+ * crypt::decrypt_copy(header, std::back_inserter(request));
+ * @endcode
+ */
+template <class Source, class Out>
+Out decrypt_copy(const Source &source, Out out) {
+  auto reader = detail::xor_reader(source);
+  using T = typename decltype(reader)::value_type;
+  if constexpr (std::is_same_v<Out, T *>) {
+    while (const std::size_t n = reader.next_chunk(out, SIZE_MAX))
+      out += n;
+  } else {
+    T chunk[detail::xor_sink_chunk / sizeof(T)];
+    while (const std::size_t n = reader.next_chunk(chunk, std::size(chunk)))
+      out = std::copy(chunk, chunk + n, out);
+  }
+  return out;
+}
+
+#if __has_include(<sys/uio.h>)
+// -----------------------------------------------------------------------------
+namespace detail {
+
+// Collects pieces into an iovec array and writes it out with writev(2).
+// Encrypted pieces are decrypted into one stack chunk; plain pieces are
+// referenced where they are.
+class xor_fd_writer {
+public:
+  explicit xor_fd_writer(int fd) : _fd(fd) {}
+
+  template <class Part> bool add(const Part &part) {
+    if constexpr (std::is_convertible_v<const Part &, std::string_view>)
+      return add_plain(part);
+    else
+      return add_encrypted(xor_reader(part));
+  }
+
+  bool add_plain(std::string_view plain) {
+    if (plain.empty())
+      return true;
+    if (_count == max_iov && !flush())
+      return false;
+    _iov[_count++] = {const_cast<char *>(plain.data()), plain.size()};
+    return true;
+  }
+
+  template <class Reader> bool add_encrypted(Reader reader) {
+    using T = typename Reader::value_type;
+    while (!reader.done()) {
+      std::size_t used = (_used + alignof(T) - 1) / alignof(T) * alignof(T);
+      if (used + sizeof(T) > sizeof(_chunk) || _count == max_iov) {
+        if (!flush())
+          return false;
+        used = 0;
+      }
+      unsigned char *at = _chunk + used;
+      const std::size_t n = reader.next_chunk(
+          reinterpret_cast<T *>(at), (sizeof(_chunk) - used) / sizeof(T));
+      // Extend the previous entry when it ends where this piece starts.
+      if (_count && end_of(_iov[_count - 1]) == at)
+        _iov[_count - 1].iov_len += n * sizeof(T);
+      else
+        _iov[_count++] = {at, n * sizeof(T)};
+      _used = used + n * sizeof(T);
+    }
+    return true;
+  }
+
+  // Writes everything collected, retrying after partial writes and EINTR.
+  bool flush() {
+    iovec *iov = _iov;
+    int left = _count;
+    while (left > 0) {
+      const ssize_t n = left == 1 ? ::write(_fd, iov->iov_base, iov->iov_len)
+                                  : ::writev(_fd, iov, left);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      auto done = static_cast<std::size_t>(n);
+      for (; left > 0 && done >= iov->iov_len; ++iov, --left)
+        done -= iov->iov_len;
+      if (left > 0) {
+        iov->iov_base = static_cast<unsigned char *>(iov->iov_base) + done;
+        iov->iov_len -= done;
+      }
+    }
+    _count = 0;
+    _used = 0;
+    return true;
+  }
+
+private:
+  static constexpr int max_iov = 16;
+
+  static unsigned char *end_of(const iovec &iov) {
+    return static_cast<unsigned char *>(iov.iov_base) + iov.iov_len;
+  }
+
+  int _fd;
+  int _count = 0;
+  std::size_t _used = 0;
+  iovec _iov[max_iov];
+  alignas(16) unsigned char _chunk[xor_sink_chunk];
+};
+
+} // namespace detail
+
+/**
+ * @brief Writes pieces to a file descriptor, decrypting the obfuscated ones
+ *        through a stack chunk.
+ *
+ * Consecutive pieces go out together in one writev(2) call, or write(2) when
+ * there is a single one, as long as they fit in the chunk.
+ *
+ * @param parts Xor_string, Xor_blob and Xor_blob_stream objects, and plain
+ *              std::string_view data such as request parameters, written in
+ *              order.
+ * @return false on failure, with errno set accordingly; some of the data may
+ *         have been written
+ *
+ * @code
+ * XorS(request, "GET /api/v1/status HTTP/1.1\r\nHost: ");
+ * crypt::write_fd(sock, request, host, std::string_view("\r\n\r\n"));
+ * @endcode
+ */
+template <class... Parts> bool write_fd(int fd, const Parts &...parts) {
+  detail::xor_fd_writer writer(fd);
+  return (writer.add(parts) && ...) && writer.flush();
+}
+#endif
+
+} // namespace crypt
@@ -0,0 +1,192 @@
+/**
+ * @file   xor_string_map.hpp
+ * @brief  This file provides a compile-time perfect-hash lookup table keyed by
+ *         obfuscated strings.
+ *
+ *         A crypt::Xor_string_map stores its keys encrypted in a
+ *         crypt::Xor_string_pool and builds, at compile time, a two-level
+ *         "hash and displace" perfect hash over their plaintext. Looking up
+ *         a string hashes it, probes exactly one slot and verifies the
+ *         candidate key in the encrypted domain, so lookups are O(1), never
+ *         decrypt anything and the keys never appear in plain text in the
+ *         binary.
+ *
+ *         The map returns the index of the key in declaration order, which is
+ *         meant to index a parallel table of handlers or values.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/xor_string_pool.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+
+namespace crypt {
+// =============================================================================
+
+// @return a seeded FNV-1a hash of @p n characters of @p string
+template <typename Char>
+constexpr std::uint64_t xor_map_hash(const Char *string, std::size_t n,
+                                     std::uint64_t seed) {
+  std::uint64_t hash =
+      14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+  for (std::size_t i = 0; i < n; ++i) {
+    hash ^= static_cast<std::make_unsigned_t<Char>>(string[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash ^ (hash >> 32);
+}
+
+// Not constexpr: reaching it while building a map stops compilation.
+inline void xor_string_map_duplicate_key() {}
+
+// -----------------------------------------------------------------------------
+
+template <typename Char, unsigned... sizes> class Xor_string_map {
+  static constexpr std::size_t table_size() {
+    std::size_t n = 1;
+    while (n < sizeof...(sizes))
+      n <<= 1;
+    return n;
+  }
+
+public:
+  // Returned by find() when the string is not a key of the map.
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  // Number of keys.
+  static constexpr std::size_t count = sizeof...(sizes);
+  // Number of buckets and of slots, a power of two.
+  static constexpr std::size_t slots = table_size();
+
+  Xor_string_pool<Char, sizes...> _keys;
+  // Per bucket: seed of the second-level hash, or -(slot + 1) when the bucket
+  // holds a single key placed directly.
+  std::array<std::int32_t, slots> _displacement;
+  // Per slot: index of the key stored there, or count when empty.
+  std::array<unsigned, slots> _slot_key;
+
+  // if every goes alright this constructor should be executed at compile time
+  constexpr Xor_string_map(const Char (&...strings)[sizes])
+      : _keys{strings...}, _displacement{}, _slot_key{} {
+    const Char *keys[] = {strings...};
+    const std::size_t lengths[] = {(sizes - 1)...};
+    std::size_t bucket[count] = {};
+    std::size_t bucket_size[slots] = {};
+    std::size_t largest = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      bucket[i] = xor_map_hash(keys[i], lengths[i], 0) & (slots - 1);
+      if (++bucket_size[bucket[i]] > largest)
+        largest = bucket_size[bucket[i]];
+    }
+    for (std::size_t i = 0; i < count; ++i)
+      for (std::size_t j = i + 1; j < count; ++j)
+        if (bucket[i] == bucket[j] && same_key(keys[i], lengths[i], keys[j],
+                                               lengths[j]))
+          xor_string_map_duplicate_key();
+    for (auto &key : _slot_key)
+      key = count;
+
+    // Place the largest buckets first, while the table is still empty.
+    for (std::size_t size = largest; size > 1; --size) {
+      for (std::size_t b = 0; b < slots; ++b) {
+        if (bucket_size[b] != size)
+          continue;
+        for (std::int32_t seed = 1;; ++seed) {
+          std::size_t placed[count] = {};
+          std::size_t n = 0;
+          bool fits = true;
+          for (std::size_t i = 0; fits && i < count; ++i) {
+            if (bucket[i] != b)
+              continue;
+            const std::size_t slot =
+                xor_map_hash(keys[i], lengths[i], seed) & (slots - 1);
+            fits = _slot_key[slot] == count;
+            for (std::size_t j = 0; fits && j < n; ++j)
+              fits = placed[j] != slot;
+            placed[n++] = slot;
+          }
+          if (!fits)
+            continue;
+          n = 0;
+          for (std::size_t i = 0; i < count; ++i)
+            if (bucket[i] == b)
+              _slot_key[placed[n++]] = static_cast<unsigned>(i);
+          _displacement[b] = seed;
+          break;
+        }
+      }
+    }
+
+    // Single-key buckets take the remaining free slots directly.
+    std::size_t free_slot = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (bucket_size[bucket[i]] != 1)
+        continue;
+      while (_slot_key[free_slot] != count)
+        ++free_slot;
+      _slot_key[free_slot] = static_cast<unsigned>(i);
+      _displacement[bucket[i]] = -static_cast<std::int32_t>(free_slot + 1);
+    }
+  }
+
+  /**
+   * @brief Looks up a string among the keys.
+   *
+   * @param key The string to look up, in plain text.
+   * @return the index of the matching key in declaration order, or npos
+   */
+  std::size_t find(std::basic_string_view<Char> key) const {
+    const std::size_t b =
+        xor_map_hash(key.data(), key.size(), 0) & (slots - 1);
+    const std::int32_t d = _displacement[b];
+    const std::size_t slot =
+        d < 0 ? static_cast<std::size_t>(-(d + 1))
+              : xor_map_hash(key.data(), key.size(), d) & (slots - 1);
+    const unsigned id = _slot_key[slot];
+    if (id == count || !_keys.equals(id, key))
+      return npos;
+    return id;
+  }
+
+  // @return true if @p key is one of the keys
+  bool contains(std::basic_string_view<Char> key) const {
+    return find(key) != npos;
+  }
+
+private:
+  static constexpr bool same_key(const Char *a, std::size_t a_length,
+                                 const Char *b, std::size_t b_length) {
+    if (a_length != b_length)
+      return false;
+    for (std::size_t i = 0; i < a_length; ++i)
+      if (a[i] != b[i])
+        return false;
+    return true;
+  }
+};
+
+} // namespace crypt
+
+
+/**
+ * @brief Creates a named compile-time perfect-hash map over encrypted keys.
+ *
+ * @param name The variable name for the crypt::Xor_string_map instance.
+ * @param ...  The keys, which must be distinct.
+ *
+ * @code
+ * XorMap(commands, "start", "stop", "status");
+ * void (*const handlers[])() = {start, stop, status};
+ * if (auto id = commands.find(input); id != commands.npos)
+ *   handlers[id]();
+ * @endcode
+ *
+ * @note The keys must be string literals of the same character type.
+ * @note Duplicate keys make the declaration fail to compile.
+ */
+#define XorMap(name, ...) constexpr crypt::Xor_string_map name{__VA_ARGS__}
@@ -0,0 +1,156 @@
+/**
+ * @file   xor_string_pool.hpp
+ * @brief  This file provides a pool of compile-time obfuscated strings stored
+ *         back to back in one contiguous encrypted blob.
+ *
+ *         Instead of scattering one crypt::Xor_string object per literal
+ *         across the binary, a crypt::Xor_string_pool keeps every literal,
+ *         null terminator included, in a single array indexed by an
+ *         offset/length table. Entries can be decrypted on demand by their
+ *         index, or the whole pool can be decrypted in a single sequential
+ *         pass, e.g. at startup.
+ *
+ *         The keystream runs over the whole blob, so every entry is encrypted
+ *         with the key at its absolute position inside the pool.
+ * @date   October 2026
+ */
+#pragma once
+
+#include <kam1k4dze/utools/cstring_obfuscator.hpp>
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+
+namespace crypt {
+// =============================================================================
+
+template <typename Char, unsigned... sizes> class Xor_string_pool {
+  static_assert(sizeof...(sizes) > 0, "a string pool needs at least one entry");
+
+  static constexpr std::array<unsigned, sizeof...(sizes)> make_offsets() {
+    std::array<unsigned, sizeof...(sizes)> offsets{};
+    const unsigned lengths[] = {sizes...};
+    unsigned pos = 0;
+    for (std::size_t i = 0; i < sizeof...(sizes); ++i) {
+      offsets[i] = pos;
+      pos += lengths[i];
+    }
+    return offsets;
+  }
+
+public:
+  // Number of strings in the pool.
+  static constexpr std::size_t count = sizeof...(sizes);
+  // Number of characters in the blob, null terminators included.
+  static constexpr std::size_t total = (sizes + ...);
+
+  // Start of each entry inside the blob.
+  static constexpr std::array<unsigned, count> _offsets = make_offsets();
+  // Size of each entry, null terminator included.
+  static constexpr std::array<unsigned, count> _sizes = {sizes...};
+
+  Char _blob[total];
+
+  // if every goes alright this constructor should be executed at compile time
+  constexpr Xor_string_pool(const Char (&...strings)[sizes]) : _blob{} {
+    unsigned pos = 0;
+    (append(strings, pos), ...);
+  }
+
+  // @return the number of characters of entry @p id, without the terminator
+  static constexpr std::size_t length(std::size_t id) { return _sizes[id] - 1; }
+
+  /**
+   * @brief Decrypts a single entry into a caller-provided buffer.
+   *
+   * Only the characters of that entry are read from the blob.
+   *
+   * @param id  Index of the entry, in declaration order.
+   * @param out Destination of at least length(id) + 1 characters.
+   * @return a view over the decrypted entry inside @p out
+   */
+  std::basic_string_view<Char> decrypt_to(std::size_t id, Char *out) const {
+    const std::size_t n = length(id);
+    detail::xor_keystream<Char>(out, _blob + _offsets[id], n,
+                                static_cast<Char>(XORKEY), _offsets[id]);
+    out[n] = '\0';
+    return {out, n};
+  }
+
+  /**
+   * @brief Checks whether entry @p id equals @p probe, in the encrypted
+   *        domain.
+   *
+   * @see Xor_string::equals
+   */
+  bool equals(std::size_t id, std::basic_string_view<Char> probe) const {
+    if (probe.size() != length(id))
+      return false;
+    return detail::xor_keystream_equal<Char>(_blob + _offsets[id],
+                                             probe.data(), probe.size(),
+                                             static_cast<Char>(XORKEY),
+                                             _offsets[id]);
+  }
+
+  /**
+   * @brief Decrypts the entry @p id, known at compile time, into a
+   *        null-terminated array returned by value.
+   */
+  template <std::size_t id>
+  std::array<Char, std::get<id>(_sizes)> decrypt_array() const {
+    std::array<Char, std::get<id>(_sizes)> out;
+    decrypt_to(id, out.data());
+    return out;
+  }
+
+  /**
+   * @brief Decrypts the whole pool in one sequential pass.
+   *
+   * Every entry of @p out is null-terminated; use entry() to look them up.
+   *
+   * @param out Destination for the whole blob.
+   */
+  void decrypt_all(Char (&out)[total]) const {
+    detail::xor_keystream<Char>(out, _blob, total, static_cast<Char>(XORKEY));
+  }
+
+  // @return entry @p id of a pool decrypted with decrypt_all()
+  static std::basic_string_view<Char> entry(const Char (&plain)[total],
+                                            std::size_t id) {
+    return {plain + _offsets[id], length(id)};
+  }
+
+private:
+  template <unsigned n>
+  constexpr void append(const Char (&string)[n], unsigned &pos) {
+    for (unsigned i = 0; i < n; ++i, ++pos)
+      _blob[pos] = encrypt_character<Char>(string[i], pos);
+  }
+};
+
+} // namespace crypt
+
+
+/**
+ * @brief Creates a named pool of compile-time encrypted C-strings.
+ *
+ * Entries are identified by their position in the argument list.
+ *
+ * @param name The variable name for the crypt::Xor_string_pool instance.
+ * @param ...  The C-strings to be encrypted.
+ *
+ * @code
+ * XorPool(messages, "Hello", "World");
+ * char buffer[16];
+ * std::cout << messages.decrypt_to(1, buffer) << std::endl; // Outputs: World
+ *
+ * char all[decltype(messages)::total];
+ * messages.decrypt_all(all);
+ * std::cout << messages.entry(all, 0) << std::endl; // Outputs: Hello
+ * @endcode
+ *
+ * @note The C-strings must be string literals of the same character type.
+ */
+#define XorPool(name, ...) constexpr crypt::Xor_string_pool name{__VA_ARGS__}
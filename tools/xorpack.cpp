@@ -0,0 +1,110 @@
+/**
+ * @file   xorpack.cpp
+ * @brief  Build-time packer writing obfuscated resource packs read at runtime
+ *         by crypt::Xor_pack (kam1k4dze/utools/xor_pack.hpp).
+ *
+ *         Usage: xorpack OUTPUT NAME=FILE [NAME=FILE...]
+ *
+ *         Every FILE is stored under NAME, encrypted with the keystream of
+ *         cstring_obfuscator.hpp. Build this tool with the same TBX_XSTR_SEED
+ *         as the program reading the pack.
+ * @date   October 2026
+ */
+#include <kam1k4dze/utools/xor_pack.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Resource {
+  std::string name;
+  std::vector<unsigned char> data;
+};
+
+std::uint64_t align_up(std::uint64_t offset) {
+  return (offset + crypt::xor_pack_alignment - 1) &
+         ~std::uint64_t{crypt::xor_pack_alignment - 1};
+}
+
+bool write_pack(const char *path, std::vector<Resource> &resources) {
+  std::vector<crypt::Xor_pack_record> records(resources.size());
+  std::uint64_t offset = sizeof(crypt::Xor_pack_header) +
+                         resources.size() * sizeof(crypt::Xor_pack_record);
+  for (std::size_t i = 0; i < resources.size(); ++i) {
+    records[i].name_offset = offset;
+    records[i].name_size = resources[i].name.size();
+    offset += resources[i].name.size();
+  }
+  for (std::size_t i = 0; i < resources.size(); ++i) {
+    offset = align_up(offset);
+    records[i].data_offset = offset;
+    records[i].data_size = resources[i].data.size();
+    offset += resources[i].data.size();
+  }
+
+  crypt::Xor_pack_header header{};
+  std::memcpy(header.magic, crypt::xor_pack_magic, sizeof(header.magic));
+  header.version = crypt::xor_pack_version;
+  header.count = static_cast<std::uint32_t>(resources.size());
+  header.alignment = crypt::xor_pack_alignment;
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(records.data()),
+            static_cast<std::streamsize>(records.size() * sizeof(records[0])));
+  for (auto &resource : resources) {
+    std::string &name = resource.name;
+    crypt::detail::xor_keystream<char>(name.data(), name.data(), name.size(),
+                                       static_cast<char>(crypt::XORKEY));
+    out.write(name.data(), static_cast<std::streamsize>(name.size()));
+  }
+  for (std::size_t i = 0; i < resources.size(); ++i) {
+    const std::vector<char> padding(
+        records[i].data_offset - static_cast<std::uint64_t>(out.tellp()), 0);
+    out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    std::vector<unsigned char> &data = resources[i].data;
+    crypt::detail::xor_keystream<unsigned char>(
+        data.data(), data.data(), data.size(),
+        static_cast<unsigned char>(crypt::XORKEY));
+    out.write(reinterpret_cast<const char *>(data.data()),
+              static_cast<std::streamsize>(data.size()));
+  }
+  return static_cast<bool>(out.flush());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s OUTPUT NAME=FILE [NAME=FILE...]\n",
+                 argv[0]);
+    return 2;
+  }
+  std::vector<Resource> resources;
+  for (int i = 2; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const std::size_t eq = arg.find('=');
+    if (eq == std::string::npos || eq == 0) {
+      std::fprintf(stderr, "xorpack: expected NAME=FILE, got '%s'\n", argv[i]);
+      return 2;
+    }
+    const std::string file = arg.substr(eq + 1);
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+      std::fprintf(stderr, "xorpack: cannot read '%s'\n", file.c_str());
+      return 1;
+    }
+    resources.push_back({arg.substr(0, eq),
+                         {std::istreambuf_iterator<char>(in),
+                          std::istreambuf_iterator<char>()}});
+  }
+  if (!write_pack(argv[1], resources)) {
+    std::fprintf(stderr, "xorpack: cannot write '%s'\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
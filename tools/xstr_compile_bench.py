@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Compile-time benchmark for the obfuscated string literals of
+cstring_obfuscator.hpp.
+
+Generates translation units with one literal of growing size, and with a
+growing number of literal sites of varying lengths, compiles each of them
+with every requested compiler and reports build time, peak compiler memory
+and object size. Use it to check that constexpr encryption stays within the
+default compiler limits, to compare keystream policies, and to catch
+regressions in the template cost of the header: --csv writes one row per
+measurement for comparison between revisions.
+
+    tools/xstr_compile_bench.py [--cxx g++,clang++] [--policy Ramp_keystream]
+                                [--sizes 1024,16384,65536,262144]
+                                [--counts 100,1000,10000] [--macro _c]
+                                [--csv results.csv]
+
+Compilers that are not installed are skipped.
+"""
+
+import argparse
+import csv
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+INCLUDE = os.path.join(ROOT, "src")
+
+
+def literal(length, salt=0):
+    return "".join(chr(ord("a") + (i * 7 + salt) % 26) for i in range(length))
+
+
+def site_length(i):
+    # Mostly identifiers and messages, with the odd long one: 8..64 chars,
+    # and 256..1024 chars for every 50th site.
+    if i % 50 == 49:
+        return 256 + (i * 37) % 769
+    return 8 + (i * 13) % 57
+
+
+def size_tu(policy, size):
+    return "\n".join([
+        "#include <kam1k4dze/utools/xor_aes.hpp>",
+        "constexpr crypt::Xor_string<%d, char, crypt::%s> s(\"%s\");"
+        % (size + 1, policy, literal(size)),
+        "int main() { static char out[%d]; return s.decrypt_to(out)[0]; }"
+        % (size + 1),
+        "",
+    ])
+
+
+def count_tu(macro, count):
+    lines = ["#include <kam1k4dze/utools/cstring_obfuscator.hpp>",
+             "void sink(const char *);"]
+    # Spread the sites over functions of 100, like real code.
+    for f in range(0, count, 100):
+        lines.append("void sites_%d() {" % f)
+        for i in range(f, min(count, f + 100)):
+            lines.append("  sink(%s(\"%s\"));"
+                         % (macro, literal(site_length(i), i)))
+        lines.append("}")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def compile_tu(cxx, flags, source, workdir):
+    """@return (seconds, peak RSS in KiB, object bytes, error or None)"""
+    path = os.path.join(workdir, "bench.cpp")
+    obj = os.path.join(workdir, "bench.o")
+    with open(path, "w") as f:
+        f.write(source)
+    if os.path.exists(obj):
+        os.remove(obj)
+    cmd = [cxx] + flags + ["-I", INCLUDE, "-c", path, "-o", obj]
+    with tempfile.TemporaryFile(mode="w+") as stderr:
+        start = time.monotonic()
+        process = subprocess.Popen(cmd, stdout=subprocess.DEVNULL,
+                                   stderr=stderr, universal_newlines=True)
+        # wait4 reports the resources of this compiler run alone. The driver
+        # forks cc1plus, whose peak is included once it has been reaped.
+        _, status, usage = os.wait4(process.pid, 0)
+        elapsed = time.monotonic() - start
+        process.returncode = status
+        stderr.seek(0)
+        errors = [l for l in stderr.read().splitlines() if "error" in l]
+    peak_kib = usage.ru_maxrss
+    if status != 0:
+        error = errors[0].split("error: ")[-1] if errors else "failed"
+        return elapsed, peak_kib, 0, error
+    return elapsed, peak_kib, os.path.getsize(obj), None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++,clang++"),
+                        help="comma-separated list of compilers")
+    parser.add_argument("--flags", default="-std=c++17 -O2")
+    parser.add_argument("--policy", default="Ramp_keystream")
+    parser.add_argument("--sizes", default="1024,16384,65536,262144")
+    parser.add_argument("--counts", default="100,1000,10000")
+    parser.add_argument("--macro", default="_c",
+                        help="macro used at every literal site, e.g. _cc")
+    parser.add_argument("--csv", help="also write the results to this file")
+    args = parser.parse_args()
+    flags = args.flags.split()
+
+    benchmarks = []
+    for size in [int(s) for s in args.sizes.split(",") if s]:
+        benchmarks.append(("size:" + args.policy, size,
+                           size_tu(args.policy, size)))
+    for count in [int(c) for c in args.counts.split(",") if c]:
+        benchmarks.append(("count:" + args.macro, count,
+                           count_tu(args.macro, count)))
+
+    rows = []
+    with tempfile.TemporaryDirectory() as workdir:
+        for cxx in [c for c in args.cxx.split(",") if c]:
+            if not shutil.which(cxx):
+                print("%s: not found, skipped" % cxx)
+                continue
+            print("%s %s" % (cxx, " ".join(flags)))
+            print("  %-26s %8s %9s %10s %12s" %
+                  ("benchmark", "n", "time [s]", "peak [MiB]", "object [B]"))
+            for name, n, source in benchmarks:
+                elapsed, peak, size, error = compile_tu(cxx, flags, source,
+                                                        workdir)
+                print("  %-26s %8d %9.2f %10.1f %12d  %s" %
+                      (name, n, elapsed, peak / 1024.0, size,
+                       error or ""))
+                rows.append([cxx, name, n, "%.3f" % elapsed, peak, size,
+                             error or ""])
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["compiler", "benchmark", "n", "seconds",
+                             "peak_kib", "object_bytes", "error"])
+            writer.writerows(rows)
+    return 1 if any(row[-1] for row in rows) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,89 @@
+/**
+ * @file   xstr_format_check.cpp
+ * @brief  Checks that XorFormatTo of xor_format.hpp produces the same text as
+ *         the formatting library on the plaintext format, and that it
+ *         rejects mismatched arguments at compile time.
+ *
+ *         Usage: xstr_format_check
+ *
+ *         Every case is formatted through XorFormatTo into a stack buffer
+ *         and into a std::string, and compared with the backend's own
+ *         format() of the same literal. A std::pair or std::tuple argument
+ *         must count as one argument. Exits with status 1 on the first
+ *         mismatch.
+ *
+ *         c++ -std=c++20 -O2 -Isrc -DTBX_XSTR_FMT tools/xstr_format_check.cpp \
+ *             -lfmt -o xstr_format_check && ./xstr_format_check
+ *
+ *         Drop -DTBX_XSTR_FMT and -lfmt to check <format>. Building with
+ *         -DXSTR_FORMAT_CHECK_MISMATCH must fail: it formats a pair with two
+ *         placeholders.
+ * @date   October 2026
+ */
+#include <kam1k4dze/utools/xor_format.hpp>
+#if defined(TBX_XSTR_FMT)
+#include <fmt/ranges.h>
+#endif
+
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+namespace backend = crypt::detail::format_backend;
+
+bool report(const char *name, std::string_view expected,
+            std::string_view actual) {
+  const bool ok = expected == actual;
+  std::printf("%s %-10s \"%.*s\"\n", ok ? "ok  " : "FAIL", name,
+              static_cast<int>(actual.size()), actual.data());
+  if (!ok)
+    std::printf("     expected \"%.*s\"\n", static_cast<int>(expected.size()),
+                expected.data());
+  return ok;
+}
+
+// Formats through a pointer into a stack buffer and through back_inserter.
+#define XSTR_FORMAT_CASE(name, literal, ...)                                   \
+  [&] {                                                                        \
+    char line[256];                                                            \
+    char *end = XorFormatTo(line, literal __VA_OPT__(, ) __VA_ARGS__);         \
+    std::string text;                                                          \
+    XorFormatTo(std::back_inserter(text), literal __VA_OPT__(, ) __VA_ARGS__); \
+    const std::string expected =                                               \
+        backend::format(literal __VA_OPT__(, ) __VA_ARGS__);                   \
+    return report(name, expected, std::string_view(line, end - line)) &&       \
+           report(name, expected, text);                                       \
+  }()
+
+bool check_all() {
+  const int id = 42;
+  const std::string ip = "10.0.0.7";
+  const char user[] = "alice";
+  bool ok = XSTR_FORMAT_CASE("literal", "progress 100%") &&
+            XSTR_FORMAT_CASE("escape", "{{}} {}", id) &&
+            XSTR_FORMAT_CASE("mixed", "user {} logged in from {}:{}", user,
+                             ip, 8080) &&
+            XSTR_FORMAT_CASE("spec", "[{:>8.3f}|{:#x}|{:<5}]", 3.14159, 255,
+                             std::string_view("ab")) &&
+            XSTR_FORMAT_CASE("indexed", "{1} {0}", "world", "hello");
+#if defined(TBX_XSTR_FMT) || defined(__cpp_lib_format_ranges)
+  // CTAD of std::tuple would unpack these into their elements.
+  ok = ok && XSTR_FORMAT_CASE("pair", "{}", std::pair<int, int>{1, 2}) &&
+       XSTR_FORMAT_CASE("tuple", "{} and {}", std::tuple<int, char>{3, 'x'},
+                        id);
+#endif
+#ifdef XSTR_FORMAT_CHECK_MISMATCH
+  char line[64];
+  XorFormatTo(line, "{} {}", std::pair<int, int>{1, 2});
+#endif
+  return ok;
+}
+
+} // namespace
+
+int main() { return check_all() ? 0 : 1; }
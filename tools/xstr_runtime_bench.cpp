@@ -0,0 +1,386 @@
+/**
+ * @file   xstr_runtime_bench.cpp
+ * @brief  Runtime benchmark for the decryption paths of the obfuscated
+ *         strings and payloads.
+ *
+ *         Usage: xstr_runtime_bench [SIZE_KIB] [ROUNDS] [WRITE_PATH]
+ *
+ *         Code size: sixteen literal sites are compiled three ways, each into
+ *         its own section, and the size of every section is reported:
+ *         - loop: the loop Xor_string::decrypt() used before the kernels;
+ *         - inline: the xor_keystream() dispatch and the scalar tail inlined
+ *           at every site, as decrypt() did before the out-of-line core;
+ *         - core: Xor_string::decrypt_to(), a call to crypt::detail::
+ *           xor_decrypt().
+ *
+ *         Throughput: a buffer of SIZE_KIB KiB (default 64) is decrypted
+ *         ROUNDS times (default 200) by the loop, then by every keystream
+ *         kernel the CPU supports and by the runtime dispatch, for
+ *         Ramp_keystream, Counter_keystream and Aes_ctr_keystream. The best
+ *         round is reported in GB/s and in TSC cycles per byte, and the
+ *         dispatch of each policy is compared with that of Ramp_keystream.
+ *
+ *         Scaling: a 32 MiB payload is decrypted by xor_decrypt_parallel()
+ *         on a Xor_thread_executor of 1, 2, 4, ... threads, up to the number
+ *         of hardware threads.
+ *
+ *         Writer (Linux): a 64 MiB payload is decrypted to WRITE_PATH
+ *         (default /tmp/xstr_runtime_bench.bin, removed afterwards) in
+ *         256 KiB chunks, serially with pwrite(2), then by Xor_async_writer
+ *         with io_uring and with its worker thread, four chunks deep. Put
+ *         WRITE_PATH on the file system of interest; /dev/shm measures the
+ *         overlap without the device.
+ *
+ *         c++ -std=c++17 -O2 -pthread -Isrc tools/xstr_runtime_bench.cpp \
+ *             -o xstr_runtime_bench && ./xstr_runtime_bench
+ *
+ *         Section sizes need GNU ld or a linker that defines __start_ and
+ *         __stop_ symbols for them (lld, gold, mold).
+ * @date   October 2026
+ */
+#include <kam1k4dze/utools/cstring_obfuscator.hpp>
+#include <kam1k4dze/utools/xor_aes.hpp>
+#include <kam1k4dze/utools/xor_parallel.hpp>
+#if __has_include(<linux/io_uring.h>)
+#include <kam1k4dze/utools/xor_async_writer.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+// =============================================================================
+// Code size
+
+// The decrypt() loop of the original Xor_string.
+template <unsigned size>
+__attribute__((always_inline)) inline void
+loop_decrypt(char *out, const crypt::Xor_string<size, char> &string) {
+  for (unsigned t = 0; t < size - 1; t++)
+    out[t] = string._string[t] ^ (static_cast<char>(crypt::XORKEY) + t);
+  out[size - 1] = 0;
+}
+
+// decrypt() before it called the out-of-line core.
+template <unsigned size>
+__attribute__((always_inline)) inline void
+inline_decrypt(char *out, const crypt::Xor_string<size, char> &string) {
+  crypt::detail::xor_keystream(out, string._string, size - 1,
+                               static_cast<char>(crypt::XORKEY));
+  out[size - 1] = 0;
+}
+
+template <unsigned size>
+__attribute__((always_inline)) inline void
+core_decrypt(char *out, const crypt::Xor_string<size, char> &string) {
+  string.decrypt_to(*reinterpret_cast<char(*)[size]>(out));
+}
+
+#define XSTR_SITE(group, decrypt, name, literal)                               \
+  __attribute__((noinline, used, section(#group))) void name(char *out) {      \
+    static constexpr crypt::Xor_string<sizeof(literal), char> string(literal); \
+    decrypt(out, string);                                                      \
+  }
+
+#define XSTR_SITES(group, decrypt)                                             \
+  XSTR_SITE(group, decrypt, group##_0, "GET")                                  \
+  XSTR_SITE(group, decrypt, group##_1, "Host: ")                               \
+  XSTR_SITE(group, decrypt, group##_2, "User-Agent: ")                         \
+  XSTR_SITE(group, decrypt, group##_3, "Content-Length")                       \
+  XSTR_SITE(group, decrypt, group##_4, "application/json")                     \
+  XSTR_SITE(group, decrypt, group##_5, "/api/v1/session/refresh")              \
+  XSTR_SITE(group, decrypt, group##_6, "SOFTWARE\\Classes\\CLSID")             \
+  XSTR_SITE(group, decrypt, group##_7, "invalid license key")                  \
+  XSTR_SITE(group, decrypt, group##_8,                                         \
+            "failed to open the configuration file")                           \
+  XSTR_SITE(group, decrypt, group##_9, "https://updates.example.com/")         \
+  XSTR_SITE(group, decrypt, group##_10, "Authorization: Bearer ")              \
+  XSTR_SITE(group, decrypt, group##_11, "%s: %d bytes received")               \
+  XSTR_SITE(group, decrypt, group##_12,                                        \
+            "the quick brown fox jumps over the lazy dog, twice over")         \
+  XSTR_SITE(group, decrypt, group##_13, "debugger detected")                   \
+  XSTR_SITE(group, decrypt, group##_14, "kernel32.dll")                        \
+  XSTR_SITE(group, decrypt, group##_15,                                        \
+            "-----BEGIN PUBLIC KEY-----\nMIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8A")
+
+XSTR_SITES(xstr_loop, loop_decrypt)
+XSTR_SITES(xstr_inline, inline_decrypt)
+XSTR_SITES(xstr_core, core_decrypt)
+
+} // namespace
+
+extern "C" {
+extern const char __start_xstr_loop[], __stop_xstr_loop[];
+extern const char __start_xstr_inline[], __stop_xstr_inline[];
+extern const char __start_xstr_core[], __stop_xstr_core[];
+}
+
+namespace {
+
+void report_code_size() {
+  std::printf("code size of 16 literal sites\n");
+  std::printf("  %-8s %6td bytes\n", "loop",
+              __stop_xstr_loop - __start_xstr_loop);
+  std::printf("  %-8s %6td bytes\n", "inline",
+              __stop_xstr_inline - __start_xstr_inline);
+  std::printf("  %-8s %6td bytes (+ one xor_decrypt<char> per binary)\n",
+              "core", __stop_xstr_core - __start_xstr_core);
+}
+
+// =============================================================================
+// Throughput
+
+std::uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// Runs @p decrypt @p rounds times and prints the best round.
+// @return the best round in GB/s
+template <class Decrypt>
+double measure(const char *name, std::size_t bytes, int rounds,
+               Decrypt &&decrypt) {
+  using clock = std::chrono::steady_clock;
+  double best_ns = 1e300;
+  std::uint64_t best_cycles = UINT64_MAX;
+  decrypt();
+  for (int r = 0; r < rounds; ++r) {
+    const auto start = clock::now();
+    const std::uint64_t start_cycles = cycles();
+    decrypt();
+    const std::uint64_t used = cycles() - start_cycles;
+    const double ns =
+        std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    if (ns < best_ns)
+      best_ns = ns;
+    if (used < best_cycles)
+      best_cycles = used;
+  }
+  std::printf("  %-12s %8.2f GB/s %8.3f cycles/B\n", name, bytes / best_ns,
+              static_cast<double>(best_cycles) / bytes);
+  return bytes / best_ns;
+}
+
+// Keeps the compiler from dropping the decrypted data.
+void consume(const void *data) { asm volatile("" : : "r"(data) : "memory"); }
+
+__attribute__((noinline)) void loop_keystream(char *dst, const char *src,
+                                              std::size_t n, char key) {
+  for (std::size_t t = 0; t < n; t++)
+    dst[t] = src[t] ^ (static_cast<char>(key) + t);
+}
+
+// @return the throughput of the dispatch in GB/s
+double report_ramp(std::size_t bytes, int rounds) {
+  std::vector<char> src(bytes), dst(bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    src[i] = static_cast<char>(i * 131 + 7);
+  const char key = static_cast<char>(crypt::XORKEY);
+  std::printf("Ramp_keystream, %zu KiB\n", bytes / 1024);
+  measure("loop", bytes, rounds, [&] {
+    loop_keystream(dst.data(), src.data(), bytes, key);
+    consume(dst.data());
+  });
+  using kernel = void (*)(char *, const char *, std::size_t, char,
+                          std::size_t);
+  const auto run = [&](const char *name, kernel k) {
+    measure(name, bytes, rounds, [&] {
+      k(dst.data(), src.data(), bytes, key, 0);
+      consume(dst.data());
+    });
+  };
+  run("scalar", &crypt::detail::xor_keystream_scalar<char>);
+#ifdef TBX_XSTR_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    run("sse2", &crypt::detail::xor_keystream_sse2<char>);
+  if (__builtin_cpu_supports("avx2"))
+    run("avx2", &crypt::detail::xor_keystream_avx2<char>);
+  if (__builtin_cpu_supports("avx512bw"))
+    run("avx512", &crypt::detail::xor_keystream_avx512<char>);
+#endif
+  return measure("dispatch", bytes, rounds, [&] {
+    crypt::detail::xor_keystream(dst.data(), src.data(), bytes, key);
+    consume(dst.data());
+  });
+}
+
+void report_counter(std::size_t bytes, int rounds, double ramp) {
+  std::vector<std::uint8_t> src(bytes), dst(bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    src[i] = static_cast<std::uint8_t>(i * 131 + 7);
+  std::printf("Counter_keystream, %zu KiB\n", bytes / 1024);
+  measure("scalar", bytes, rounds, [&] {
+    crypt::detail::counter_keystream_scalar(dst.data(), src.data(), bytes,
+                                            crypt::XORSEED, 0);
+    consume(dst.data());
+  });
+#ifdef TBX_XSTR_X86_KERNELS
+  using kernel = std::size_t (*)(std::uint8_t *, const std::uint8_t *,
+                                 std::size_t, std::uint32_t, std::size_t);
+  const auto run = [&](const char *name, kernel k) {
+    measure(name, bytes, rounds, [&] {
+      k(dst.data(), src.data(), bytes, crypt::XORSEED, 0);
+      consume(dst.data());
+    });
+  };
+  if (__builtin_cpu_supports("sse4.1"))
+    run("sse41", &crypt::detail::counter_keystream_sse41);
+  if (__builtin_cpu_supports("avx2"))
+    run("avx2", &crypt::detail::counter_keystream_avx2);
+  if (__builtin_cpu_supports("avx512f"))
+    run("avx512", &crypt::detail::counter_keystream_avx512);
+#endif
+  const double rate = measure("dispatch", bytes, rounds, [&] {
+    crypt::detail::counter_keystream(dst.data(), src.data(), bytes,
+                                     crypt::XORSEED);
+    consume(dst.data());
+  });
+  std::printf("  %-12s %8.2fx Ramp_keystream\n", "cost", ramp / rate);
+}
+
+void report_aes(std::size_t bytes, int rounds, double ramp) {
+  std::vector<std::uint8_t> src(bytes), dst(bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    src[i] = static_cast<std::uint8_t>(i * 131 + 7);
+  std::printf("Aes_ctr_keystream, %zu KiB\n", bytes / 1024);
+  measure("software", bytes, rounds, [&] {
+    crypt::detail::aes_ctr_software<false>(dst.data(), src.data(), bytes,
+                                           crypt::XORAESKEY,
+                                           crypt::XORAESNONCE, 0);
+    consume(dst.data());
+  });
+#ifdef TBX_XSTR_X86_KERNELS
+  using kernel = std::size_t (*)(std::uint8_t *, const std::uint8_t *,
+                                 std::size_t, const crypt::detail::aes128_key &,
+                                 std::uint64_t, std::size_t);
+  const auto run = [&](const char *name, kernel k) {
+    measure(name, bytes, rounds, [&] {
+      k(dst.data(), src.data(), bytes, crypt::XORAESKEY, crypt::XORAESNONCE,
+        0);
+      consume(dst.data());
+    });
+  };
+  if (__builtin_cpu_supports("aes"))
+    run("aesni", &crypt::detail::aes_ctr_aesni);
+  if (__builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f"))
+    run("vaes", &crypt::detail::aes_ctr_vaes);
+#endif
+  const double rate = measure("dispatch", bytes, rounds, [&] {
+    crypt::detail::aes_ctr(dst.data(), src.data(), bytes, crypt::XORAESKEY,
+                           crypt::XORAESNONCE, 0);
+    consume(dst.data());
+  });
+  std::printf("  %-12s %8.2fx Ramp_keystream\n", "cost", ramp / rate);
+}
+
+void report_parallel(int rounds) {
+  constexpr std::size_t bytes = 32 << 20;
+  std::vector<std::byte> src(bytes), dst(bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    src[i] = static_cast<std::byte>(i * 131 + 7);
+  const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+  rounds = std::max(1, rounds / 20);
+  std::printf("xor_decrypt_parallel, %zu MiB, %u hardware threads\n",
+              bytes >> 20, hardware);
+  double single = 0;
+  for (unsigned threads = 1;; threads = std::min(threads * 2, hardware)) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%u threads", threads);
+    const double rate = measure(name, bytes, rounds, [&] {
+      crypt::xor_decrypt_parallel(src.data(), dst.data(), bytes, 0,
+                                  crypt::Xor_thread_executor(threads));
+      consume(dst.data());
+    });
+    if (threads == 1)
+      single = rate;
+    else
+      std::printf("  %-12s %8.2fx\n", "speedup", rate / single);
+    if (threads == hardware)
+      break;
+  }
+}
+
+#if __has_include(<linux/io_uring.h>)
+void report_writer(const char *path, int rounds) {
+  using Writer = crypt::Xor_async_writer;
+  constexpr std::size_t bytes = 64 << 20;
+  std::vector<std::byte> src(bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    src[i] = static_cast<std::byte>(i * 131 + 7);
+  const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    std::perror(path);
+    return;
+  }
+  rounds = std::max(1, rounds / 40);
+  std::printf("Xor_async_writer, %zu MiB to %s\n", bytes >> 20, path);
+  std::vector<std::byte> chunk(Writer::default_chunk);
+  bool ok = true;
+  measure("serial", bytes, rounds, [&] {
+    crypt::Xor_blob_stream stream(src.data(), bytes);
+    off_t offset = 0;
+    while (const std::size_t n =
+               stream.next_chunk(chunk.data(), chunk.size())) {
+      ok &= ::pwrite(fd, chunk.data(), n, offset) == static_cast<ssize_t>(n);
+      offset += static_cast<off_t>(n);
+    }
+  });
+  for (const Writer::Backend backend :
+       {Writer::Backend::io_uring, Writer::Backend::thread}) {
+    const char *name =
+        backend == Writer::Backend::io_uring ? "io_uring" : "thread";
+    Writer writer;
+    ok &= writer.open(Writer::default_depth, Writer::default_chunk, backend);
+    if (writer.backend() != backend) {
+      std::printf("  %-12s unavailable\n", name);
+      continue;
+    }
+    measure(name, bytes, rounds, [&] {
+      ok &= writer.write(fd, crypt::Xor_blob_stream(src.data(), bytes));
+    });
+  }
+  if (!ok)
+    std::perror("  write failed");
+  ::close(fd);
+  ::unlink(path);
+}
+#endif
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t bytes =
+      (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64) * 1024;
+  const int rounds = argc > 2 ? std::atoi(argv[2]) : 200;
+  if (bytes == 0 || rounds <= 0) {
+    std::fprintf(stderr, "usage: %s [SIZE_KIB] [ROUNDS] [WRITE_PATH]\n",
+                 argv[0]);
+    return 2;
+  }
+  report_code_size();
+  const double ramp = report_ramp(bytes, rounds);
+  report_counter(bytes, rounds, ramp);
+  report_aes(bytes, rounds, ramp);
+  report_parallel(rounds);
+#if __has_include(<linux/io_uring.h>)
+  report_writer(argc > 3 ? argv[3] : "/tmp/xstr_runtime_bench.bin", rounds);
+#endif
+  return 0;
+}